@@ -0,0 +1,142 @@
+// apnea.cpp – implementation
+#include "apnea.h"
+#include "breath.h"  // breathTakeAbsPeak_Lpm()
+#include "cardio.h"  // cardioBlock(), cardioTake()
+#include <math.h>
+
+static ApneaEvent ring[APNEA_RING];
+static uint32_t seq = 0;
+
+// 1 s blocks, the window is the last APNEA_WIN_BLOCKS of them
+static float    blk[APNEA_WIN_BLOCKS];
+static uint8_t  blkHead = 0, blkCount = 0;
+static float    blkMax = NAN;
+static uint32_t blkStartMs = 0;
+
+// reference amplitude
+static float    ref = 0.0f;
+static uint16_t refBlocks = 0;
+
+// open event
+static bool     inEvent = false;
+static uint32_t evtStartMs = 0;
+static float    evtMinRatio = 1.0f;
+static uint8_t  lowRun = 0, lowRunMax = 0;  // consecutive blocks under APNEA_FRAC
+
+static uint32_t monitoredMs = 0;
+
+// ------------------------------------------------
+void apneaReset() {
+  seq = 0;
+  blkHead = blkCount = 0;
+  blkMax = NAN;
+  blkStartMs = millis();
+  ref = 0.0f;
+  refBlocks = 0;
+  inEvent = false;
+  evtMinRatio = 1.0f;
+  lowRun = lowRunMax = 0;
+  monitoredMs = 0;
+}
+
+// max over the newest k blocks
+static float recentMax(uint8_t k) {
+  float m = 0.0f;
+  for (uint8_t i = 0; i < k && i < blkCount; ++i)
+    m = max(m, blk[(blkHead + APNEA_WIN_BLOCKS - 1 - i) % APNEA_WIN_BLOCKS]);
+  return m;
+}
+
+static void closeEvent(uint32_t endMs) {
+  ApneaEvent& e = ring[seq % APNEA_RING];
+  e.start_ms = evtStartMs;
+  e.dur_s    = (uint16_t)min<uint32_t>(0xFFFF, (endMs - evtStartMs) / 1000);
+  e.type     = lowRunMax >= APNEA_WIN_BLOCKS ? EVT_APNEA : EVT_HYPOPNEA;
+  e.minPct   = (uint8_t)constrain(evtMinRatio * 100.0f, 0.0f, 255.0f);
+  const CardioResult c = cardioTake();
+  e.airway   = e.type != EVT_APNEA || !c.valid ? AIRWAY_UNKNOWN
+             : c.oscillating                  ? AIRWAY_OPEN
+                                              : AIRWAY_CLOSED;
+  e.hrBpm    = e.airway == AIRWAY_OPEN ? (uint8_t)min(255.0f, c.hr_bpm) : 0;
+  seq++;
+  inEvent = false;
+}
+
+static void closeBlock(uint32_t now, float amp) {
+  blk[blkHead] = amp;
+  blkHead = (blkHead + 1) % APNEA_WIN_BLOCKS;
+  if (blkCount < APNEA_WIN_BLOCKS) blkCount++;
+  monitoredMs += APNEA_BLOCK_MS;
+
+  const float win = recentMax(APNEA_WIN_BLOCKS);
+  if (refBlocks < APNEA_REF_BLOCKS) {
+    // plain mean of the window amplitude until the reference is established
+    if (blkCount == APNEA_WIN_BLOCKS) {
+      refBlocks++;
+      ref += (win - ref) / refBlocks;
+    }
+    cardioBlock(false);
+    return;
+  }
+
+  const float ratio = ref > 0.0f ? win / ref : 1.0f;
+  const bool  low = amp < APNEA_FRAC * ref;
+  lowRun = low ? (uint8_t)min(255, lowRun + 1) : 0;
+  cardioBlock(low);
+
+  if (!inEvent) {
+    if (blkCount == APNEA_WIN_BLOCKS && win < APNEA_HYPO_FRAC * ref) {
+      inEvent = true;
+      evtStartMs = now - APNEA_WIN_BLOCKS * APNEA_BLOCK_MS;
+      evtMinRatio = ratio;
+      lowRunMax = lowRun;
+      cardioTake();  // drop stretches from before the event
+    } else {
+      ref += (win - ref) * (APNEA_BLOCK_MS * 1e-3f / APNEA_REF_TAU_S);
+    }
+    return;
+  }
+
+  evtMinRatio = min(evtMinRatio, ratio);
+  lowRunMax = max(lowRunMax, lowRun);
+  if (recentMax(3) >= APNEA_RECOVER_FRAC * ref) closeEvent(now - APNEA_BLOCK_MS);
+}
+
+void apneaService(bool monitoring) {
+  const uint32_t now = millis();
+  const float p = breathTakeAbsPeak_Lpm();
+
+  if (!monitoring) {
+    // a pause breaks the window; an open event can't be scored across it
+    blkCount = 0;
+    blkMax = NAN;
+    blkStartMs = now;
+    inEvent = false;
+    lowRun = 0;
+    cardioBlock(false);
+    return;
+  }
+
+  if (isfinite(p) && !(p <= blkMax)) blkMax = p;
+  if (now - blkStartMs < APNEA_BLOCK_MS) return;
+  blkStartMs += APNEA_BLOCK_MS;
+  if (now - blkStartMs >= APNEA_BLOCK_MS) blkStartMs = now;  // fell behind, resync
+
+  if (isfinite(blkMax)) closeBlock(now, blkMax);
+  else blkCount = 0;  // no samples in a whole block, treat as a gap
+  blkMax = NAN;
+}
+
+float apneaAHI() {
+  if (monitoredMs < 600000UL) return 0.0f;  // first 10 min is not meaningful
+  return seq * 3600000.0f / monitoredMs;
+}
+
+bool apneaInEvent() { return inEvent; }
+uint32_t apneaSeq() { return seq; }
+
+bool apneaGet(uint32_t s, ApneaEvent& out) {
+  if (s >= seq || seq - s > APNEA_RING) return false;
+  out = ring[s % APNEA_RING];
+  return true;
+}
@@ -0,0 +1,54 @@
+// apnea.h – streaming apnea/hypopnea detection and AHI
+#ifndef APNEA_H
+#define APNEA_H
+
+#include <Arduino.h>
+
+/*  Amplitude = peak |respiratory flow| per 1 s block (breath.h), and the
+    10 s amplitude is the max of the last 10 blocks, so "below X for 10 s"
+    is simply window max < X. The reference is a ~2 min average of the
+    window amplitude, frozen during events.
+      apnea:     10 consecutive blocks below APNEA_FRAC of the reference
+      hypopnea:  window below HYPO_FRAC (≥30 % reduction) for ≥10 s,
+                 flow only, there is no oximetry on this device
+    An event ends once any of the last 3 blocks is back above RECOVER_FRAC.
+    Apneas are labelled by the airway (cardio.h): cardiogenic oscillations
+    through the quiet stretch mean it was open, a central apnea.           */
+
+constexpr uint32_t APNEA_BLOCK_MS     = 1000;
+constexpr uint8_t  APNEA_WIN_BLOCKS   = 10;      // 10 s
+constexpr float    APNEA_FRAC         = 0.10f;
+constexpr float    APNEA_HYPO_FRAC    = 0.70f;
+constexpr float    APNEA_RECOVER_FRAC = 0.80f;
+constexpr uint16_t APNEA_REF_BLOCKS   = 60;      // learn the reference this long first
+constexpr float    APNEA_REF_TAU_S    = 120.0f;
+constexpr uint8_t  APNEA_RING         = 32;
+
+enum ApneaType : uint8_t {
+  EVT_APNEA = 0,
+  EVT_HYPOPNEA
+};
+
+enum ApneaAirway : uint8_t {
+  AIRWAY_UNKNOWN = 0,  // hypopnea, or too short / disturbed to tell
+  AIRWAY_OPEN,         // central
+  AIRWAY_CLOSED        // obstructive
+};
+
+struct ApneaEvent {
+  uint32_t start_ms;   // millis
+  uint16_t dur_s;
+  ApneaType type;
+  uint8_t  minPct;     // lowest window amplitude, % of reference
+  ApneaAirway airway;
+  uint8_t  hrBpm;      // cardiogenic rate if open, else 0
+};
+
+void  apneaReset();                    // new session: clears count, AHI and reference
+void  apneaService(bool monitoring);   // every loop; false pauses (blower off, degraded, leak)
+float apneaAHI();                      // events per monitored hour
+bool  apneaInEvent();
+uint32_t apneaSeq();                   // events completed so far
+bool  apneaGet(uint32_t seq, ApneaEvent& out);
+
+#endif  // APNEA_H
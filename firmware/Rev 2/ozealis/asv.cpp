@@ -0,0 +1,124 @@
+// asv.cpp – implementation
+#include "asv.h"
+#include "breath.h"  // breathSeq(), breathGet()
+#include <math.h>
+
+// 10 s ventilation buckets, mL
+static float    bucket[ASV_BUCKETS];
+static uint8_t  head = 0, filled = 0;
+static float    cur = 0.0f;        // bucket being filled
+static float    windowSum = 0.0f;  // Σ of the closed buckets
+static uint32_t bucketStartMs = 0;
+
+static uint32_t seenSeq = 0;
+static float    recentMV = 0.0f;   // L/min
+static float    ps = ASV_PS_MIN_CM;
+
+static bool     periodic = false;
+static float    cycle_s = 0.0f;
+
+// ------------------------------------------------
+void asvReset(float ps_cm) {
+  head = filled = 0;
+  cur = windowSum = 0.0f;
+  bucketStartMs = millis();
+  seenSeq = breathSeq();
+  recentMV = 0.0f;
+  ps = constrain(ps_cm, ASV_PS_MIN_CM, ASV_PS_MAX_CM);
+  periodic = false;
+  cycle_s = 0.0f;
+}
+
+// oldest → newest view of the closed buckets
+static inline float bk(uint8_t i) {
+  return bucket[(head + ASV_BUCKETS - filled + i) % ASV_BUCKETS];
+}
+
+static void detectPeriodic() {
+  periodic = false;
+  cycle_s = 0.0f;
+  if (filled < ASV_BUCKETS) return;
+
+  const float mean = windowSum / filled;
+  float var = 0.0f;
+  for (uint8_t i = 0; i < filled; ++i) var += (bk(i) - mean) * (bk(i) - mean);
+  if (mean <= 0.0f || var <= 0.0f) return;
+  if (sqrtf(var / filled) / mean < ASV_PB_CV) return;
+
+  float best = 0.0f;
+  uint8_t bestLag = 0;
+  for (uint8_t lag = ASV_PB_LAG_MIN; lag <= ASV_PB_LAG_MAX; ++lag) {
+    float c = 0.0f;
+    for (uint8_t i = lag; i < filled; ++i) c += (bk(i) - mean) * (bk(i - lag) - mean);
+    c = c / var * filled / (filled - lag);  // unbiased for the shorter overlap
+    if (c > best) { best = c; bestLag = lag; }
+    else if (best >= ASV_PB_CORR) break;   // first peak, not its multiples
+  }
+  if (best >= ASV_PB_CORR) {
+    periodic = true;
+    cycle_s = bestLag * (ASV_BUCKET_MS / 1000.0f);
+  }
+}
+
+// one bounded step per breath (or per silent bucket) toward the target
+static void stepSupport() {
+  const float target = asvTarget_Lpm();
+  if (target <= 0.0f) return;
+  const float step = ASV_GAIN_CM * (target - recentMV) / target;
+  ps = constrain(ps + constrain(step, -ASV_STEP_MAX_CM, ASV_STEP_MAX_CM), ASV_PS_MIN_CM, ASV_PS_MAX_CM);
+}
+
+static void closeBucket() {
+  // a bucket without a single breath is an apnea, recent ventilation falls with it
+  if (cur <= 0.0f) {
+    recentMV *= 0.75f;
+    stepSupport();
+  }
+
+  if (filled == ASV_BUCKETS) windowSum -= bucket[head];
+  else filled++;
+  bucket[head] = cur;
+  windowSum += cur;
+  head = (head + 1) % ASV_BUCKETS;
+  cur = 0.0f;
+  detectPeriodic();
+}
+
+void asvUpdate() {
+  const uint32_t now = millis();
+  if (now - bucketStartMs >= ASV_BUCKETS * ASV_BUCKET_MS) asvReset(ps);  // not serviced for a whole window
+  while (now - bucketStartMs >= ASV_BUCKET_MS) {
+    bucketStartMs += ASV_BUCKET_MS;
+    closeBucket();
+  }
+
+  BreathRecord r;
+  const uint32_t seq = breathSeq();
+  if (seq - seenSeq > BREATH_RING) seenSeq = seq - BREATH_RING;
+  for (; seenSeq < seq; ++seenSeq) {
+    if (!breathGet(seenSeq, r)) continue;
+    cur += r.vt_mL;
+
+    const float period_s = (r.ti_ms + r.te_ms) * 1e-3f;
+    if (period_s < 1.0f) continue;
+    const float mv = r.vt_mL * 1e-3f * 60.0f / period_s;
+    recentMV = recentMV > 0.0f ? recentMV + 0.25f * (mv - recentMV) : mv;
+    stepSupport();
+  }
+}
+
+float asvPS_cm() { return ps; }
+
+float asvMV_Lpm() {
+  if (!filled) return 0.0f;
+  return windowSum * 1e-3f / (filled * ASV_BUCKET_MS / 60000.0f);
+}
+
+float asvRecentMV_Lpm() { return recentMV; }
+
+float asvTarget_Lpm() {
+  return filled >= ASV_MIN_BUCKETS ? ASV_TARGET_FRAC * asvMV_Lpm() : 0.0f;
+}
+
+bool  asvPeriodicBreathing() { return periodic; }
+float asvCycle_s() { return cycle_s; }
@@ -0,0 +1,39 @@
+// asv.h – minute ventilation tracking, ASV pressure support, periodic breathing
+#ifndef ASV_H
+#define ASV_H
+
+#include <Arduino.h>
+
+/*  Ventilation is kept in fixed 10 s buckets (Σ Vt per bucket); the long
+    window is the last ASV_BUCKETS of them, so the running MV is one add and
+    one subtract per bucket. Target = ASV_TARGET_FRAC · long MV.
+    Each completed breath moves pressure support by a bounded step toward
+    closing the gap between recent ventilation (breath‑by‑breath, smoothed
+    over ~4 breaths) and the target.
+    Periodic breathing: normalised autocorrelation of the bucket series at
+    40–90 s lags, with enough spread between buckets to be waxing/waning
+    rather than noise.                                                       */
+
+constexpr uint32_t ASV_BUCKET_MS    = 10000;
+constexpr uint8_t  ASV_BUCKETS      = 18;      // 3 min window
+constexpr uint8_t  ASV_MIN_BUCKETS  = 6;       // 1 min before the target is trusted
+constexpr float    ASV_TARGET_FRAC  = 0.90f;
+constexpr float    ASV_PS_MIN_CM    = 3.0f;
+constexpr float    ASV_PS_MAX_CM    = 15.0f;
+constexpr float    ASV_GAIN_CM      = 8.0f;    // PS change per 100 % ventilation shortfall
+constexpr float    ASV_STEP_MAX_CM  = 1.0f;    // per breath
+constexpr uint8_t  ASV_PB_LAG_MIN   = 4;       // 40 s
+constexpr uint8_t  ASV_PB_LAG_MAX   = 9;       // 90 s
+constexpr float    ASV_PB_CORR      = 0.5f;
+constexpr float    ASV_PB_CV        = 0.3f;    // bucket std / mean
+
+void  asvReset(float ps_cm);       // blower start or mode change, PS seed
+void  asvUpdate();                 // every papLoop, picks up new breaths
+float asvPS_cm();                  // current pressure support
+float asvMV_Lpm();                 // long‑window minute ventilation, 0 until known
+float asvRecentMV_Lpm();           // breath‑by‑breath, smoothed
+float asvTarget_Lpm();             // 0 until ASV_MIN_BUCKETS filled
+bool  asvPeriodicBreathing();
+float asvCycle_s();                // dominant period when periodic, else 0
+
+#endif  // ASV_H
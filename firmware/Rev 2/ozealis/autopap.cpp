@@ -1,5 +1,6 @@
 //autopap.cpp
 #include "autopap.h"
+#include "estimator.h"
 
 // ----------------‑private state‑----------------
 static PapLimits limits;  // copy of user config
@@ -9,13 +10,17 @@ static float epapBase = 0.0f;   // ramp, autoCPAP, etc
 static float epap_cm = 5.0f;    // current expiratory target
 static float ipap_cm = 9.0f;    // current inspiratory target
 static float flowProxy = 0.0f;  // latest ΔP (hPa)
+static float flowLpm = 0.0f;    // calibrated flow (L/min)
 static uint32_t rampStart = 0;
 static bool blowerOn = false;
+static volatile uint32_t autoStops = 0;
+static bool degraded = false;   // one pressure sensor lost
+static float degradedCm = 0.0f; // fixed pressure held while degraded
 
-// simple helper
-static inline uint8_t cm2duty(float cm) {
-  return constrain((uint8_t)(cm * 16), 0, 255);
-}
+static uint32_t lastCtlUs = 0;  // closed‑loop step timing
+
+// auto‑titration start and range, user limits or learned (nights.h)
+static float titrStart = 4.0f, titrFloor = 4.0f, titrCeil = 15.0f;
 
 // ------------------------------------------------
 void papBegin(const PapLimits &cfg) {
@@ -24,6 +29,8 @@ void papBegin(const PapLimits &cfg) {
   ipap_cm = epap_cm + limits.delta;
   rampStart = millis();
   blowerOn = false;
+  papSeedFromNights();
+  titrReset(titrStart);
 }
 
 // ------------------------------------------------
@@ -31,12 +38,14 @@ TherapyMode papGetMode() {
   return mode;
 }
 void papSetMode(TherapyMode m) {
+  if (m == MODE_ASV && mode != MODE_ASV) asvReset(limits.delta);
   mode = m;
 }
 
 float papGetSetpointCm() {
+  if (degraded) return degradedCm;
   return (mode == MODE_BIPAP || mode == MODE_ASV) ?  // dual‑level
-           (flowProxy >= 0 ? ipap_cm : epap_cm)
+           (trigInspiring() ? ipap_cm : epap_cm)
                                                   :  // insp / exp
            epap_cm;                                  // CPAP
 }
@@ -45,46 +54,193 @@ float papGetFlowProxy() {
   return flowProxy;
 }
 
+float papGetFlowLpm() {
+  return flowLpm;
+}
+
+void papSetAutoTitrate(bool on) {
+  if (on && !limits.autoTitrate) titrReset(titrStart);
+  limits.autoTitrate = on;
+}
+
+void papSetAutoRamp(bool on) {
+  limits.autoRamp = on;
+}
+
+bool papBlowerOn() {
+  return blowerOn;
+}
+
+uint32_t papAutoStops() {
+  return autoStops;
+}
+
+bool papAutoTitrate() {
+  return limits.autoTitrate;
+}
+
+void papSetLearn(bool on) {
+  limits.learn = on;
+  papSeedFromNights();
+}
+
+void papSeedFromNights() {
+  const NightProposal p = nightPropose(limits.pMin, limits.pMax);
+  if (limits.learn && p.learned) {
+    titrStart = p.start_cm;
+    titrFloor = p.floor_cm;
+    titrCeil = p.ceil_cm;
+  } else {
+    titrStart = titrFloor = limits.pMin;
+    titrCeil = limits.pMax;
+  }
+}
+
+bool papIsDegraded() {
+  return degraded;
+}
+
+void papSetDegraded(bool on) {
+  if (on == degraded) return;
+  degraded = on;
+  if (on) {
+    // lower of the current base and the cap; the cap wins over pMin
+    const float base = epapBase > 0.0f ? epapBase : limits.pMin;
+    degradedCm = min(max(limits.pMin, base), PAP_DEGRADED_MAX_CM);
+    flowCalAbort();
+    hoseCalAbort();
+  }
+}
+
 // ------------------------------------------------
+// open loop: calibration runs and degraded mode, controller re‑seeded on the way out
 static void applyBlower(float targetCm) {
-  setMotorAmplitude(cm2duty(targetCm));
+  setMotorAmplitude(pctlFeedForward(targetCm));
+  pctlReset(targetCm);
+  transReset(targetCm);
+  lastCtlUs = 0;
+}
+
+// raise the outlet target by the predicted hose drop so the patient end sits on it
+static float hoseCompensated(float targetCm) {
+  const float comp = constrain(hPa_to_cmH2O(hoseDrop_hPa()), -HOSE_MAX_COMP_CM, HOSE_MAX_COMP_CM);
+  return max(0.0f, targetCm + comp);
+}
+
+// closed loop on mask gauge pressure. Target and measurement both carry the
+// (capped) hose drop, so the error is patient target − patient pressure and the
+// feed‑forward sees the outlet pressure the blower actually has to make.
+static void regulateBlower(float targetCm, float pMask) {
+  float meas_hPa = NAN;
+  if (estValid() && estConfidence() >= 0.5f) meas_hPa = estMaskGauge_hPa();
+  else if (isfinite(sensorAmbient_hPa())) meas_hPa = pMask - sensorAmbient_hPa();
+
+  const uint32_t now = micros();
+  const float dt = lastCtlUs ? (now - lastCtlUs) * 1e-6f : 0.0f;
+  lastCtlUs = now;
+
+  setMotorAmplitude(pctlUpdate(hoseCompensated(targetCm), hPa_to_cmH2O(meas_hPa), dt));
 }
 
 // ------------------------------------------------
-void papLoop() {
-  /* 1. Acquire pressures → flow proxy */
-  float pMask, pBlower;
-  if (!readPressures(pMask, pBlower)) return;  // fall‑back handled inside
+void papLoop(float pMask, float pBlower, bool bothOK) {
+  /* 1. Pressures → flow proxy. The control step has already drained the
+        FIFOs this period; a second drain would throw those slots away. */
+
+  /* 1a. Degraded: one LPS22 lost, the estimator carries the other side.
+         No flow-based decisions, just a conservative fixed pressure, and
+         only if the blower was already running: without flow there is no
+         auto-start, and the mask may not even be on. */
+  if (degraded) {
+    flowProxy = estValid() ? estDiff_hPa() : 0.0f;
+    flowLpm = flowFromDiff_Lpm(flowProxy);
+    if (blowerOn) {
+      epap_cm = ipap_cm = degradedCm;
+      applyBlower(min(degradedCm, PAP_DEGRADED_MAX_CM));
+    }
+    return;
+  }
+  if (!bothOK) return;
   flowProxy = pBlower - pMask;                 // hPa  (+ve = insp)
+  if (estValid() && estConfidence() >= 0.5f)
+    flowProxy = estDiff_hPa();                 // fused, same sign/units
+  flowLpm = flowFromDiff_Lpm(flowProxy);       // L/min
+
+  /* 1b. Guided flow calibration owns the blower while active */
+  if (flowCalActive()) {
+    if (!blowerOn) {
+      restartMotor();
+      blowerOn = true;
+      rampStart = millis();
+    }
+    flowCalService(flowProxy);
+    applyBlower(flowCalSetpointCm());
+    return;
+  }
+
+  /* 1c. Hose identification, open hose end, blower steps only */
+  if (hoseCalActive()) {
+    if (!blowerOn) {
+      restartMotor();
+      blowerOn = true;
+      rampStart = millis();
+    }
+    hoseCalService();
+    applyBlower(hoseCalSetpointCm());
+    return;
+  }
 
   /* 2. Auto‑Start / Auto‑Stop */
-  if (!blowerOn && limits.autoStart && abs(flowProxy) > 0.8f) {
+  if (!blowerOn && limits.autoStart && fabsf(flowLpm) > FLOW_AUTOSTART_LPM) {
     restartMotor();
     blowerOn = true;
     rampStart = millis();
+    asvReset(limits.delta);
+    titrReset(titrStart);
   }
-  if (blowerOn && limits.autoStop && abs(flowProxy) < 0.3f && (millis() - rampStart) > 5000) {
+  if (blowerOn && limits.autoStop && fabsf(flowLpm) < FLOW_AUTOSTOP_LPM && (millis() - rampStart) > 5000) {
     setMotorAmplitude(0);
     blowerOn = false;
+    pctlReset(0.0f);
+    lastCtlUs = 0;
+    autoStops++;
   }
   if (!blowerOn) return;
 
-  /* 3. Ramp‑Up (CPAP only) */
+  /* 2a. Mask off: huge leak, no point pushing pressure into the room.
+         Hold a low standby and resume as soon as the mask seals again. */
+  if (leakMaskOff()) {
+    applyBlower(LEAK_STANDBY_CM);
+    return;
+  }
+
+  /* 3. Ramp‑Up (CPAP only), auto‑titration under the ramp ceiling.
+        Auto‑ramp holds pMin until sleep onset and ramps from there; the
+        onset is per session, so an auto‑stop/start doesn't ramp again. */
   if (mode == MODE_CPAP) {
-    uint32_t t = millis() - rampStart;
-    float frac = limits.rampSecs ? min(1.0f, t / (limits.rampSecs * 1000.0f)) : 1.0f;
+    uint32_t from = rampStart;
+    if (limits.autoRamp && sleepSessionStartMs()) {
+      const uint32_t hold = sleepOnsetMs() ? sleepOnsetMs() - sleepSessionStartMs() : SLEEP_HOLD_MAX_MS;
+      from = sleepSessionStartMs() + min(hold, SLEEP_HOLD_MAX_MS);
+    }
+    const int32_t t = (int32_t)(millis() - from);
+    float frac = t <= 0 ? 0.0f : limits.rampSecs ? min(1.0f, t / (limits.rampSecs * 1000.0f)) : 1.0f;
     epapBase = limits.pMin + frac * (limits.pMax - limits.pMin);
+    if (limits.autoTitrate) epapBase = min(epapBase, titrUpdate(titrFloor, titrCeil));
     epap_cm = epapBase;
   }
 
-  /* 4. EPAP / IPAP adjustment by mode */
+  /* 4. EPAP / IPAP adjustment by mode. Ventilation is tracked in every
+        mode so periodic breathing is reported under CPAP too. */
+  asvUpdate();
+  if (mode != MODE_CPAP) trigCommand();  // IPAP/EPAP follows the trigger engine from this tick
   switch (mode) {
     case MODE_CPAP:
       // In CPAP the IPAP setpoint equals the baseline (no EPR on inspiration)
       ipap_cm = epapBase;
 
       // EPAP lowered only on expiration
-      if (flowProxy < 0 && limits.epr > 0)
+      if (breathPhase() == BR_EXP && limits.epr > 0)
           epap_cm = max(limits.pMin, epapBase - limits.epr);
       else
           epap_cm = epapBase;
@@ -96,12 +252,12 @@ void papLoop() {
       break;
 
     case MODE_ASV:
-      // simplified ASV: boost IPAP if minute‑vent < 85 %
-      // (real ASV needs running MV average — omitted for brevity)
-      ipap_cm = constrain(epap_cm + limits.delta, limits.pMin, limits.pMax + limits.delta);
+      // pressure support servoed breath by breath to 90 % of the 3 min MV
+      ipap_cm = constrain(epap_cm + asvPS_cm(), limits.pMin, limits.pMax + limits.delta);
       break;
   }
 
-  /* 5. Drive blower */
-  applyBlower(papGetSetpointCm());
+  /* 5. Drive blower, set‑point is at the patient end. Phase steps
+        become rise/fall trajectories here, one table lookup per tick. */
+  regulateBlower(transUpdate(papGetSetpointCm()), pMask);
 }
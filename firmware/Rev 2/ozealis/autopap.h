@@ -4,7 +4,18 @@
 
 #include <Arduino.h>
 #include "motor.h"   // setMotorAmplitude()
-#include "sensor.h"  // readPressures()
+#include "sensor.h"  // PressureSample, sensor health
+#include "flowcal.h" // flowFromDiff_Lpm()
+#include "hose.h"    // hoseDrop_hPa()
+#include "breath.h"  // breathPhase()
+#include "pressctl.h" // pctlUpdate()
+#include "asv.h"     // asvPS_cm()
+#include "titrate.h" // titrUpdate()
+#include "leak.h"    // leakMaskOff()
+#include "transition.h" // transUpdate()
+#include "sleep.h"   // sleepOnsetMs()
+#include "trigger.h" // trigCommand()
+#include "nights.h"  // nightPropose()
 
 // ─── user‑configurable limits passed in at boot ──────────────
 struct PapLimits {
@@ -15,6 +26,9 @@ struct PapLimits {
   bool autoStart;     // flow‑triggered start
   bool autoStop;      // flow‑triggered stop
   uint8_t epr;        // 0‑3 cm automatic pressure relief
+  bool autoTitrate = true;  // CPAP: EPAP follows titrate.h within pMin..pMax, or the learned range
+  bool autoRamp = false;    // CPAP: hold pMin until sleep onset, then ramp
+  bool learn = true;        // auto‑titration seeded from previous nights
 };
 
 enum TherapyMode : uint8_t {
@@ -23,13 +37,27 @@ enum TherapyMode : uint8_t {
   MODE_ASV
 };
 
+// single‑sensor degraded mode: fixed pressure, hard capped
+constexpr float PAP_DEGRADED_MAX_CM = 10.0f;
+
 // ─────────── API ───────────
 void papBegin(const PapLimits &cfg);
-void papLoop();  // call every 50 ms
+void papLoop(float pMask_hPa, float pBlower_hPa, bool bothOK);  // each control period, with its drained batch mean
 TherapyMode papGetMode();
 void papSetMode(TherapyMode m);
 
 float papGetSetpointCm();  // current target (cmH₂O)
 float papGetFlowProxy();   // latest ΔP (hPa)
+float papGetFlowLpm();     // calibrated flow (L/min, +ve = insp)
+
+void papSetAutoTitrate(bool on);  // settings.autoPap
+bool papAutoTitrate();
+void papSetAutoRamp(bool on);     // settings.autoRamp
+bool papBlowerOn();
+uint32_t papAutoStops();          // auto‑stops so far; the UI loop ends the session on a change
+void papSetLearn(bool on);        // settings.learn
+void papSeedFromNights();         // after a night is stored, start/range for the next session
+void papSetDegraded(bool on);  // one LPS22 lost → hold conservative pressure
+bool papIsDegraded();
 
 #endif
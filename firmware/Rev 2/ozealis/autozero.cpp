@@ -0,0 +1,127 @@
+// autozero.cpp – implementation
+#include "autozero.h"
+#include <Preferences.h>
+#include <math.h>
+
+static AutoZeroModel model;
+static Preferences azPrefs;  // NVS namespace "cal"
+
+static float    lastT1 = AZ_TREF_C, lastT2 = AZ_TREF_C;
+static float    offset = 0.0f;
+static bool     dirty = false;
+static bool     saveNow = false;  // checkpoint when the blower starts
+static uint32_t lastSaveMs = 0;
+
+// zero‑flow gating
+static bool     zeroFlow = false;
+static uint32_t zeroSinceMs = 0;
+
+// window accumulator (Welford)
+static uint32_t winStartMs = 0;
+static uint16_t winN = 0;
+static float    winMean = 0.0f, winM2 = 0.0f;
+static float    winT1 = 0.0f, winT2 = 0.0f;
+
+static inline float evalModel(float t1, float t2) {
+  return model.c[0] + model.c[1] * (t1 - AZ_TREF_C) + model.c[2] * (t2 - AZ_TREF_C);
+}
+
+static void resetWindow(uint32_t now) {
+  winStartMs = now;
+  winN = 0;
+  winMean = winM2 = winT1 = winT2 = 0.0f;
+}
+
+// ------------------------------------------------
+void azBegin() {
+  azPrefs.begin("cal", true);
+  if (azPrefs.getBytesLength("az") == sizeof(AutoZeroModel)) {
+    azPrefs.getBytes("az", &model, sizeof(model));
+  }
+  azPrefs.end();
+  if (!isfinite(model.c[0]) || !isfinite(model.c[1]) || !isfinite(model.c[2])) model = AutoZeroModel{};
+  offset = evalModel(lastT1, lastT2);
+  lastSaveMs = millis();
+  Serial.printf("AutoZero: c0=%.3f c1=%.4f c2=%.4f hPa (%lu updates)\n",
+                model.c[0], model.c[1], model.c[2], (unsigned long)model.updates);
+}
+
+const AutoZeroModel& azGetModel() { return model; }
+
+void azReset() {
+  model = AutoZeroModel{};
+  offset = evalModel(lastT1, lastT2);
+  dirty = true;
+}
+
+float azOffset_hPa() { return offset; }
+
+void azSetZeroFlow(bool blowerStopped) {
+  const uint32_t now = millis();
+  if (blowerStopped && !zeroFlow) zeroSinceMs = now;
+  if (!blowerStopped && zeroFlow) saveNow = true;
+  zeroFlow = blowerStopped;
+  if (!zeroFlow) resetWindow(now);
+}
+
+// one recursive least‑squares step on x = [1, T1−Tref, T2−Tref]
+static void rlsUpdate(float y, float t1, float t2) {
+  const float x[3] = { 1.0f, t1 - AZ_TREF_C, t2 - AZ_TREF_C };
+  float Px[3];
+  for (int i = 0; i < 3; ++i)
+    Px[i] = model.P[i][0] * x[0] + model.P[i][1] * x[1] + model.P[i][2] * x[2];
+  const float denom = AZ_FORGET + x[0] * Px[0] + x[1] * Px[1] + x[2] * Px[2];
+  const float e = y - evalModel(t1, t2);
+
+  // forgetting only while P is below its prior, so unexcited directions don't wind up
+  const AutoZeroModel prior;
+  const float trace  = model.P[0][0] + model.P[1][1] + model.P[2][2];
+  const float trace0 = prior.P[0][0] + prior.P[1][1] + prior.P[2][2];
+  const float lambda = trace < trace0 ? AZ_FORGET : 1.0f;
+
+  for (int i = 0; i < 3; ++i) model.c[i] += Px[i] / denom * e;
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      model.P[i][j] = (model.P[i][j] - Px[i] * Px[j] / denom) / lambda;
+  model.updates++;
+  dirty = true;
+}
+
+float azFeed(float rawDiff, float t1, float t2) {
+  if (isfinite(t1)) lastT1 = t1;
+  if (isfinite(t2)) lastT2 = t2;
+  offset = evalModel(lastT1, lastT2);
+
+  const uint32_t now = millis();
+  if (!zeroFlow || now - zeroSinceMs < AZ_SETTLE_MS || !isfinite(rawDiff)) return offset;
+
+  if (winN == 0) winStartMs = now;
+  winN++;
+  const float d = rawDiff - winMean;
+  winMean += d / winN;
+  winM2   += d * (rawDiff - winMean);
+  winT1   += lastT1;
+  winT2   += lastT2;
+
+  if (now - winStartMs >= AZ_WINDOW_MS && winN >= 4) {
+    const float sd  = sqrtf(winM2 / (winN - 1));
+    const float wT1 = winT1 / winN, wT2 = winT2 / winN;
+    const bool  near = model.updates == 0 || fabsf(winMean - evalModel(wT1, wT2)) < AZ_MAX_JUMP_HPA;
+    if (sd < AZ_MAX_STD_HPA && near) {
+      rlsUpdate(winMean, wT1, wT2);
+      offset = evalModel(lastT1, lastT2);
+    }
+    resetWindow(now);
+  }
+  return offset;
+}
+
+void azService() {
+  if (!dirty || (!saveNow && millis() - lastSaveMs < AZ_SAVE_MS)) return;
+  azPrefs.begin("cal", false);
+  azPrefs.putBytes("az", &model, sizeof(model));
+  azPrefs.end();
+  dirty = false;
+  saveNow = false;
+  lastSaveMs = millis();
+}
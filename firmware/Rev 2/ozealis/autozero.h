@@ -0,0 +1,31 @@
+// autozero.h – mask/blower LPS22 offset learning with temperature drift
+#ifndef AUTOZERO_H
+#define AUTOZERO_H
+
+#include <Arduino.h>
+
+// offset(T1,T2) = c[0] + c[1]·(T1 − AZ_TREF_C) + c[2]·(T2 − AZ_TREF_C)   (hPa)
+// T1/T2 are the die temperatures the LPS22s report with every FIFO slot.
+constexpr float    AZ_TREF_C      = 25.0f;
+constexpr uint32_t AZ_SETTLE_MS   = 3000;    // blower spin‑down before learning
+constexpr uint32_t AZ_WINDOW_MS   = 1000;    // one observation per window
+constexpr float    AZ_MAX_STD_HPA = 0.05f;   // reject windows with breathing/gusts
+constexpr float    AZ_MAX_JUMP_HPA= 1.0f;    // reject windows far from the model
+constexpr float    AZ_FORGET      = 0.998f;  // RLS forgetting per window
+constexpr uint32_t AZ_SAVE_MS     = 600000;  // NVS write at most every 10 min, or at blower start
+
+struct AutoZeroModel {
+  float    c[3]    = { 0.0f, 0.0f, 0.0f };
+  float    P[3][3] = { { 0.25f, 0, 0 }, { 0, 1e-3f, 0 }, { 0, 0, 1e-3f } };
+  uint32_t updates = 0;  // accepted windows, lifetime
+};
+
+void  azBegin();                                        // load model from NVS
+float azFeed(float rawDiff_hPa, float t1_C, float t2_C); // each fresh batch, returns offset
+float azOffset_hPa();                                   // offset at last temperatures
+void  azSetZeroFlow(bool blowerStopped);                // call each loop
+void  azService();                                      // deferred NVS persistence
+const AutoZeroModel& azGetModel();
+void  azReset();
+
+#endif  // AUTOZERO_H
@@ -5,6 +5,12 @@
 #include "logic.h"  // currentMode / epochOffset / eventFlag
 #include <Preferences.h>
 #include "datalog.h"
+#include "flowcal.h"
+#include "hose.h"
+#include "i2cbus.h"
+#include "control.h"
+#include "sched.h"
+#include "span.h"
 #include "ota_secure.h"
 #include <Arduino.h>
 #include <driver/ledc.h>   // pour ledcSetup, ledcAttachPin, etc.
@@ -25,6 +31,8 @@ BLECharacteristic *char_pressure = nullptr, *char_vin = nullptr,
                   *char_logDl = nullptr, *char_otaCmd = nullptr,
                   *char_otaSt = nullptr;
 BLECharacteristic* char_faultCsv = nullptr;
+BLECharacteristic* char_i2cStats = nullptr;
+BLECharacteristic* char_spans = nullptr;
 
 
 bool bleConnected = false;
@@ -40,6 +48,18 @@ class FaultLogReadCallback : public BLECharacteristicCallbacks {
   }
 };
 
+class I2cStatsReadCallback : public BLECharacteristicCallbacks {
+  void onRead(BLECharacteristic* c) override {
+    c->setValue(i2cStatsCsv().c_str());
+  }
+};
+
+class SpanReadCallback : public BLECharacteristicCallbacks {
+  void onRead(BLECharacteristic* c) override {
+    c->setValue(spanCsv().c_str());
+  }
+};
+
 // ================== Settings R/W =================
 void loadSettings() {
   prefs.begin("cpap", true);
@@ -53,6 +73,18 @@ void loadSettings() {
   String nvsName = prefs.getString("bleName", "Ozealis");
   nvsName.toCharArray(settings.bleName, sizeof(settings.bleName));
   settings.bleAdvertise = prefs.getBool("bleAdv", true);
+  settings.ctlHz = prefs.getUShort("ctlHz", 200);
+  settings.autoRamp = prefs.getBool("autoRamp", false);
+  settings.learn = prefs.getBool("learn", true);
+  settings.riseMs = prefs.getUShort("riseMs", 300);
+  settings.fallMs = prefs.getUShort("fallMs", 400);
+  settings.riseShape = prefs.getUChar("riseShape", 0);
+  settings.trig.flow_Lpm = prefs.getFloat("trigFlow", 3.0f);
+  settings.trig.slope_Lps = prefs.getFloat("trigSlope", 40.0f);
+  settings.trig.cyclePct = prefs.getUChar("cyclePct", 25);
+  settings.trig.tiMin_ms = prefs.getUShort("tiMin", 300);
+  settings.trig.tiMax_ms = prefs.getUShort("tiMax", 3000);
+  settings.trig.teMin_ms = prefs.getUShort("teMin", 400);
   prefs.end();
 }
 
@@ -66,6 +98,18 @@ void saveSettings() {
   prefs.putFloat("delta", settings.deltaCm);
   prefs.putString("bleName", settings.bleName);
   prefs.putBool("bleAdv", settings.bleAdvertise);
+  prefs.putUShort("ctlHz", settings.ctlHz);
+  prefs.putBool("autoRamp", settings.autoRamp);
+  prefs.putBool("learn", settings.learn);
+  prefs.putUShort("riseMs", settings.riseMs);
+  prefs.putUShort("fallMs", settings.fallMs);
+  prefs.putUChar("riseShape", settings.riseShape);
+  prefs.putFloat("trigFlow", settings.trig.flow_Lpm);
+  prefs.putFloat("trigSlope", settings.trig.slope_Lps);
+  prefs.putUChar("cyclePct", settings.trig.cyclePct);
+  prefs.putUShort("tiMin", settings.trig.tiMin_ms);
+  prefs.putUShort("tiMax", settings.trig.tiMax_ms);
+  prefs.putUShort("teMin", settings.trig.teMin_ms);
   prefs.end();
 }
 
@@ -102,8 +146,45 @@ class SettingsCallback : public BLECharacteristicCallbacks {
     }
     if (doc.containsKey("pMin")) settings.pMin = doc["pMin"].as<float>();
     if (doc.containsKey("pMax")) settings.pMax = doc["pMax"].as<float>();
-    if (doc.containsKey("auto")) settings.autoPap = doc["auto"].as<bool>();
+    if (doc.containsKey("auto")) {
+      settings.autoPap = doc["auto"].as<bool>();
+      papSetAutoTitrate(settings.autoPap);
+    }
     if (doc.containsKey("ramp")) settings.rampSecs = doc["ramp"].as<float>();
+    if (doc.containsKey("autoRamp")) {
+      settings.autoRamp = doc["autoRamp"].as<bool>();
+      papSetAutoRamp(settings.autoRamp);
+    }
+    if (doc.containsKey("learn")) {
+      settings.learn = doc["learn"].as<bool>();
+      papSetLearn(settings.learn);
+    }
+    // loop() job statistics on Serial, then a fresh window: {"sched":"report"}
+    if (doc.containsKey("sched")) {
+      schedReport();
+      schedStatsReset();
+    }
+    // per-stage latency histograms: {"spans":"report"|"reset"}
+    if (doc.containsKey("spans")) {
+      const char* cmd = doc["spans"].as<const char*>();
+      if (cmd && !strcmp(cmd, "report")) spanReport();
+      else if (cmd && !strcmp(cmd, "reset")) spanReset();
+    }
+    // across-night titration model: {"nights":"report"|"reset"}
+    if (doc.containsKey("nights")) {
+      const char* cmd = doc["nights"].as<const char*>();
+      if (cmd && !strcmp(cmd, "report")) {
+        nightReport(settings.pMin, settings.pMax);
+      } else if (cmd && !strcmp(cmd, "reset")) {
+        nightReset();
+        papSeedFromNights();
+        Serial.println("Nights: model cleared");
+      }
+    }
+    if (doc.containsKey("usageReset") && doc["usageReset"].as<bool>()) {
+      sleepResetUsage();
+      Serial.println("Usage: counters cleared");
+    }
 
     if (doc.containsKey("mode"))
       settings.mode = (TherapyMode)doc["mode"].as<uint8_t>(),
@@ -113,6 +194,60 @@ class SettingsCallback : public BLECharacteristicCallbacks {
       snprintf(settings.bleName, sizeof(settings.bleName), "%s", doc["bleName"].as<const char*>());
     }
     if (doc.containsKey("bleAdv")) settings.bleAdvertise = doc["bleAdv"].as<int>() != 0;
+    if (doc.containsKey("ctlHz")) {
+      settings.ctlHz = constrain(doc["ctlHz"].as<uint16_t>(), CONTROL_HZ_MIN, CONTROL_HZ_MAX);
+      controlSetRate(settings.ctlHz);
+    }
+    // pressure transition shaping: {"riseMs":300,"fallMs":400,"riseShape":0}
+    if (doc.containsKey("riseMs") || doc.containsKey("fallMs") || doc.containsKey("riseShape")) {
+      if (doc.containsKey("riseMs")) settings.riseMs = min<uint16_t>(doc["riseMs"].as<uint16_t>(), TRANS_MAX_MS);
+      if (doc.containsKey("fallMs")) settings.fallMs = min<uint16_t>(doc["fallMs"].as<uint16_t>(), TRANS_MAX_MS);
+      if (doc.containsKey("riseShape")) settings.riseShape = min<uint8_t>(doc["riseShape"].as<uint8_t>(), TRANS_LINEAR);
+      transConfigure(settings.riseMs, settings.fallMs, (TransShape)settings.riseShape);
+    }
+
+    // BiPAP/ASV trigger: {"trigFlow":3,"trigSlope":40,"cyclePct":25,"tiMin":300,"tiMax":3000,"teMin":400}
+    {
+      TrigConfig& t = settings.trig;
+      bool changed = false;
+      if (doc.containsKey("trigFlow"))  { t.flow_Lpm  = constrain(doc["trigFlow"].as<float>(), 0.5f, 20.0f); changed = true; }
+      if (doc.containsKey("trigSlope")) { t.slope_Lps = constrain(doc["trigSlope"].as<float>(), 0.0f, 500.0f); changed = true; }
+      if (doc.containsKey("cyclePct"))  { t.cyclePct  = constrain(doc["cyclePct"].as<int>(), 5, 80); changed = true; }
+      if (doc.containsKey("tiMin"))     { t.tiMin_ms  = constrain(doc["tiMin"].as<int>(), 100, 1500); changed = true; }
+      if (doc.containsKey("tiMax"))     { t.tiMax_ms  = constrain(doc["tiMax"].as<int>(), 800, 4000); changed = true; }
+      if (doc.containsKey("teMin"))     { t.teMin_ms  = constrain(doc["teMin"].as<int>(), 100, 2000); changed = true; }
+      if (changed) trigConfigure(t);
+    }
+
+    // guided flow calibration: {"flowCal":"start"|"abort"|"reset"}, {"flowRef":<L/min>}
+    if (doc.containsKey("flowCal")) {
+      const char* cmd = doc["flowCal"].as<const char*>();
+      if (cmd && !strcmp(cmd, "start")) {
+        hoseCalAbort();
+        flowCalStart();
+        if (currentMode != MODE_RUNNING) enterMode(MODE_STARTUP);
+      } else if (cmd && !strcmp(cmd, "abort")) {
+        flowCalAbort();
+      } else if (cmd && !strcmp(cmd, "reset")) {
+        flowResetCal();
+      }
+    }
+    // hose identification, mask off: {"hoseCal":"start"|"abort"|"reset"}
+    if (doc.containsKey("hoseCal")) {
+      const char* cmd = doc["hoseCal"].as<const char*>();
+      if (cmd && !strcmp(cmd, "start")) {
+        flowCalAbort();
+        hoseCalStart();
+        if (currentMode != MODE_RUNNING) enterMode(MODE_STARTUP);
+      } else if (cmd && !strcmp(cmd, "abort")) {
+        hoseCalAbort();
+      } else if (cmd && !strcmp(cmd, "reset")) {
+        hoseResetCal();
+      }
+    }
+    if (doc.containsKey("ahtMs")) ahtSetPeriod(doc["ahtMs"].as<uint32_t>());
+    if (doc.containsKey("flowRef") && !flowCalReference(doc["flowRef"].as<float>()))
+      Serial.println("Flow: reference ignored, not sampling");
 
     saveSettings();
     Serial.println("BLE settings updated & saved");
@@ -172,6 +307,14 @@ void startBLE() {
   char_faultCsv->setCallbacks(new FaultLogReadCallback());
   char_faultCsv->setValue("");
 
+  char_i2cStats = svc->createCharacteristic(UUID_CHAR_I2CSTATS, BLECharacteristic::PROPERTY_READ);
+  char_i2cStats->setCallbacks(new I2cStatsReadCallback());
+  char_i2cStats->setValue("");
+
+  char_spans = svc->createCharacteristic(UUID_CHAR_SPANS, BLECharacteristic::PROPERTY_READ);
+  char_spans->setCallbacks(new SpanReadCallback());
+  char_spans->setValue("");
+
   char_logDl->setCallbacks(new LogReadCallback());
   char_logDl->setValue("");
 
@@ -197,11 +340,12 @@ void startBLE() {
   char_hoseTemp->setValue("NAN");
   char_modStat->setValue("0");
 
-  DynamicJsonDocument jd(192);
+  DynamicJsonDocument jd(256);
   jd["pMin"] = settings.pMin;
   jd["pMax"] = settings.pMax;
   jd["auto"] = settings.autoPap;
   jd["ramp"] = settings.rampSecs;
+  jd["autoRamp"] = settings.autoRamp;
   jd["mode"] = (uint8_t)settings.mode;
   jd["delta"] = settings.deltaCm;
   jd["bleName"] = settings.bleName;
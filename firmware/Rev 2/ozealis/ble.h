@@ -24,11 +24,13 @@
 #define UUID_CHAR_HOSE_TEMP "0012"    // hose temp        °C (notify)
 #define UUID_CHAR_MOD_STATUS "0013"   // bit-field: bit0 humid, bit1 hose (notify)
 #define UUID_CHAR_LIVECSV "0020"      // notify, 120-byte CSV every sec
-#define UUID_CHAR_LOGDL "0021"        // read, full-session CSV (long read)
+#define UUID_CHAR_LOGDL "0021"        // read, datalog CSV one page per read, "" at the end
 #define UUID_CHAR_SETTINGS_RW "00F0"  // JSON settings R/W
 #define UUID_CHAR_OTA_CMD "0007"      // write JSON {ssid,pwd,url}
 #define UUID_CHAR_OTA_ST "0008"       // notify "IDLE|n%|OK|ERR"
 #define UUID_CHAR_FAULTCSV "0022"
+#define UUID_CHAR_I2CSTATS "0023"     // read, per-device I2C latency/error CSV
+#define UUID_CHAR_SPANS "0024"        // read, per-stage latency histogram CSV
 
 extern BLECharacteristic* char_faultCsv;
 extern BLECharacteristic* char_otaSt;
@@ -40,12 +42,19 @@ struct CPAPSettings {
   float pMax = 15.0f;
   bool autoPap = true;
   float rampSecs = 300.0f;
+  bool autoRamp = false;     // hold pMin until sleep onset, then ramp
+  bool learn = true;         // seed auto‑titration from previous nights
   float targetRH = 70.0f;
   float tubeDelta = 4.0f;
   TherapyMode mode = MODE_CPAP;
   float deltaCm = 4.0f;
   char bleName[20] = "Ozealis";
   bool bleAdvertise = true;  // if false → keep BLE radio off next boot
+  uint16_t ctlHz = 200;      // control task rate, 100‑250 Hz
+  uint16_t riseMs = 300;     // EPAP → IPAP / EPR release shaping
+  uint16_t fallMs = 400;     // IPAP → EPAP / EPR drop shaping
+  uint8_t riseShape = 0;     // TransShape: 0 cosine, 1 exponential, 2 linear
+  TrigConfig trig;           // BiPAP/ASV trigger and cycle
 };
 
 // Accessory module live status
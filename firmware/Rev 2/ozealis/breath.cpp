@@ -0,0 +1,192 @@
+// breath.cpp – implementation
+#include "breath.h"
+#include "flowcal.h"  // flowFromDiff_Lpm()
+#include "leak.h"
+#include "trigger.h"  // trigSample()
+#include "snore.h"    // snoreAdd()
+#include "cardio.h"   // cardioAdd()
+#include <math.h>
+
+static BreathRecord ring[BREATH_RING];
+static uint32_t seq = 0;
+
+static BreathPhase phase = BR_UNKNOWN;
+static bool     haveQ = false;
+static uint32_t lastUs = 0;
+static float    qf = 0.0f;          // calibrated flow, L/min
+static float    resp = 0.0f;        // qf − leak at this pressure
+static float    absPeak = NAN;      // for breathTakeAbsPeak_Lpm()
+
+// zero crossings of resp, onset candidates
+static uint32_t zcUpUs = 0, zcDnUs = 0;
+static float    volSinceUp = 0.0f;  // mL inspired since the last up crossing
+
+// current breath
+static uint32_t inspUs = 0, expUs = 0, phaseUs = 0;
+static bool     haveInsp = false;   // an insp onset to close a breath against
+static float    peakI = 0.0f, peakE = 0.0f, vt = 0.0f;
+static uint16_t latMs = 0;
+static double   qInt = 0.0;         // ∫qf dt over the breath, L/min·s
+static double   sqrtPInt = 0.0;     // ∫√Pm dt over the breath, for the leak conductance
+static float    sqrtPm = 0.0f;
+static FlowShape shape;             // of the current inspiration
+static SnoreResult vib;             // of the current inspiration
+
+// smoothed statistics
+static float avgPeak = 20.0f, avgPeriod_s = 0.0f, avgVt = 0.0f, avgLat = 0.0f;
+
+// ------------------------------------------------
+void breathBegin() {
+  phase = BR_UNKNOWN;
+  haveQ = haveInsp = false;
+  resp = qf = 0.0f;
+  leakReset();
+  seq = 0;
+  avgPeak = 20.0f;
+  avgPeriod_s = avgVt = avgLat = 0.0f;
+}
+
+static void closeBreath(uint32_t nextInspUs) {
+  BreathRecord& r = ring[seq % BREATH_RING];
+  r.inspOnset_us = inspUs;
+  r.expOnset_us  = expUs;
+  r.ti_ms        = (uint16_t)min<uint32_t>(0xFFFF, (expUs - inspUs) / 1000);
+  r.te_ms        = (uint16_t)min<uint32_t>(0xFFFF, (nextInspUs - expUs) / 1000);
+  r.peakInsp_Lpm = peakI;
+  r.peakExp_Lpm  = peakE;
+  r.vt_mL        = vt;
+  r.detLat_ms    = latMs;
+  r.flatPct      = (uint8_t)(shape.flatness * 100.0f);
+  r.flowLimited  = shape.valid && shape.limited;
+  r.flutter      = shape.valid && shape.flutter > FLIM_FLUTTER_TH;
+  r.trigLat_ms   = trigLatencyFor(inspUs);
+  r.vibIdx       = vib.valid ? vib.index : 0.0f;
+  r.snore        = vib.valid && vib.snore;
+  seq++;
+
+  // a whole breath nets zero volume, what is left over is the leak
+  const float period_s = (nextInspUs - inspUs) * 1e-6f;
+  if (period_s > 0.5f) {
+    leakBreath(qInt, sqrtPInt);
+    avgPeriod_s = avgPeriod_s > 0.0f ? avgPeriod_s + 0.2f * (period_s - avgPeriod_s) : period_s;
+  }
+  avgPeak += 0.2f * (peakI - avgPeak);
+  avgVt    = avgVt > 0.0f ? avgVt + 0.2f * (vt - avgVt) : vt;
+  avgLat  += 0.2f * (latMs - avgLat);
+}
+
+static void enterInsp(uint32_t now) {
+  const uint32_t onset = zcUpUs ? zcUpUs : now;
+  if (haveInsp && phase == BR_EXP) closeBreath(onset);
+  latMs = (uint16_t)min<uint32_t>(0xFFFF, (now - onset) / 1000);
+  inspUs = phaseUs = onset;
+  haveInsp = true;
+  peakI = resp;
+  peakE = 0.0f;
+  vt = volSinceUp;
+  qInt = sqrtPInt = 0.0;
+  shape = FlowShape{};
+  vib = SnoreResult{};
+  flimStart();
+  snorePhase(true);
+  phase = BR_INSP;
+}
+
+static void enterExp(uint32_t now) {
+  expUs = phaseUs = zcDnUs ? zcDnUs : now;
+  peakE = -resp;
+  shape = flimFinish();
+  vib = snoreInspDone();
+  snorePhase(false);
+  phase = BR_EXP;
+}
+
+// ------------------------------------------------
+void breathTrack(const PressureSample* s, uint8_t n, float ambient) {
+  for (uint8_t i = 0; i < n; ++i) {
+    if (!isfinite(s[i].pMask_hPa) || !isfinite(s[i].pBlower_hPa)) continue;
+    const float q = flowFromDiff_Lpm(s[i].pBlower_hPa - s[i].pMask_hPa);
+    const uint32_t t = s[i].t_us;
+
+    // a gap in full pairs breaks the waveform, start over
+    if (!haveQ || t - lastUs > 500000) {
+      qf = q;
+      lastUs = t;
+      haveQ = true;
+      phase = BR_UNKNOWN;
+      haveInsp = false;
+      zcUpUs = zcDnUs = 0;
+      volSinceUp = 0.0f;
+      trigReset();
+      snorePhase(false);
+      continue;
+    }
+    const float dt = (int32_t)(t - lastUs) * 1e-6f;
+    lastUs = t;
+    if (dt <= 0.0f) continue;
+
+    qf += 0.5f * (q - qf);
+    const float pm_cm = isfinite(ambient) ? hPa_to_cmH2O(s[i].pMask_hPa - ambient) : 0.0f;
+    const float leak = leakSample(qf, pm_cm, dt);
+    sqrtPm = sqrtf(max(LEAK_P_FLOOR_CM, pm_cm));
+
+    const float prev = resp;
+    resp = qf - leak;
+    if (prev <= 0.0f && resp > 0.0f) { zcUpUs = t; volSinceUp = 0.0f; }
+    if (prev >= 0.0f && resp < 0.0f) zcDnUs = t;
+    if (resp > 0.0f) volSinceUp += resp * dt * (1000.0f / 60.0f);
+    trigSample(resp, dt, t);
+    if (!(fabsf(resp) <= absPeak)) absPeak = fabsf(resp);  // NAN → first value
+    qInt += (double)qf * dt;
+    sqrtPInt += (double)sqrtPm * dt;
+
+    const float th = max(BREATH_TH_MIN_LPM, BREATH_TH_FRAC * avgPeak);
+    const bool  held = t - phaseUs >= BREATH_MIN_PHASE_MS * 1000UL;
+
+    switch (phase) {
+      case BR_UNKNOWN:
+        if (resp > th) enterInsp(t);
+        break;
+      case BR_INSP:
+        if (resp > 0.0f) vt += resp * dt * (1000.0f / 60.0f);
+        peakI = max(peakI, resp);
+        flimAdd(resp);
+        if (resp < -th && held) enterExp(t);
+        break;
+      case BR_EXP:
+        peakE = max(peakE, -resp);
+        if (resp > th && held) enterInsp(t);
+        break;
+    }
+
+    snoreAdd(s[i].pMask_hPa);
+    cardioAdd(resp);
+
+    if (phase != BR_UNKNOWN && t - phaseUs > BREATH_LOST_MS * 1000UL) {
+      phase = BR_UNKNOWN;
+      haveInsp = false;
+    }
+  }
+}
+
+BreathPhase breathPhase()  { return phase; }
+float breathRespFlow_Lpm() { return haveQ ? resp : NAN; }
+float breathLeak_Lpm()     { return leakTotal_Lpm(); }
+
+float breathTakeAbsPeak_Lpm() {
+  const float p = absPeak;
+  absPeak = NAN;
+  return p;
+}
+
+uint32_t breathSeq() { return seq; }
+
+bool breathGet(uint32_t s, BreathRecord& out) {
+  if (s >= seq || seq - s > BREATH_RING) return false;
+  out = ring[s % BREATH_RING];
+  return true;
+}
+
+float breathRate_bpm()   { return avgPeriod_s > 0.0f ? 60.0f / avgPeriod_s : 0.0f; }
+float breathVt_mL()      { return avgVt; }
+float breathLatency_ms() { return avgLat; }
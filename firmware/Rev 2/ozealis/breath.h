@@ -0,0 +1,57 @@
+// breath.h – streaming breath segmentation at the FIFO sample rate
+#ifndef BREATH_H
+#define BREATH_H
+
+#include <Arduino.h>
+#include "sensor.h"  // PressureSample
+#include "flowlim.h"
+
+/*  Respiratory flow = calibrated flow − leak at the current mask pressure
+    (leak.h, conductance refit over each whole breath). A phase switch needs the flow past ±threshold, where the
+    threshold scales with the recent peak flow, and a minimum time in the
+    current phase. Onsets are back‑dated to the zero crossing that led to the
+    switch, the delay between the two is kept as the detection latency.      */
+
+constexpr float    BREATH_TH_MIN_LPM    = 2.0f;   // floor of the switch threshold
+constexpr float    BREATH_TH_FRAC       = 0.15f;  // of the average peak insp flow
+constexpr uint32_t BREATH_MIN_PHASE_MS  = 250;    // shortest Ti or Te accepted
+constexpr uint32_t BREATH_LOST_MS       = 15000;  // no switch this long → phase unknown
+constexpr uint8_t  BREATH_RING          = 16;     // records kept for consumers
+
+enum BreathPhase : uint8_t {
+  BR_UNKNOWN = 0,  // no breathing seen yet, or lost
+  BR_INSP,
+  BR_EXP
+};
+
+// One complete breath, emitted at the next inspiration onset
+struct BreathRecord {
+  uint32_t inspOnset_us;  // sample clock (micros)
+  uint32_t expOnset_us;
+  uint16_t ti_ms, te_ms;
+  float    peakInsp_Lpm;  // respiratory flow, leak removed
+  float    peakExp_Lpm;   // magnitude
+  float    vt_mL;         // inspired volume
+  uint16_t detLat_ms;     // insp zero crossing → detection
+  uint8_t  flatPct;       // inspiratory flatness, % (flowlim.h)
+  bool     flowLimited;   // flat or scooped inspiration
+  bool     flutter;       // snore‑like vibration on inspiration
+  uint16_t trigLat_ms;    // onset → IPAP command (trigger.h), 0xFFFF = not commanded
+  float    vibIdx;        // inspiratory / expiratory pressure vibration (snore.h), 0 = n/a
+  bool     snore;
+};
+
+void  breathBegin();
+void  breathTrack(const PressureSample* s, uint8_t n, float ambient_hPa);  // per acquisition
+BreathPhase breathPhase();
+float breathRespFlow_Lpm();   // current flow with the leak removed
+float breathLeak_Lpm();       // total leak now (vent + unintentional)
+float breathTakeAbsPeak_Lpm();// max |resp| since the last call, NAN if no samples
+
+uint32_t breathSeq();                               // breaths completed so far
+bool  breathGet(uint32_t seq, BreathRecord& out);   // false once overwritten
+float breathRate_bpm();       // smoothed over recent breaths, 0 if none
+float breathVt_mL();          // smoothed
+float breathLatency_ms();     // smoothed detection latency
+
+#endif  // BREATH_H
@@ -3,6 +3,7 @@
 #include "ble.h"             // BLE advertising globals
 #include "led.h"
 #include "buzzer.h"
+#include "sequencer.h"
 #include <Preferences.h>
 
 static constexpr uint8_t  BTN_PIN              = BTN_SIG;     // alias
@@ -16,6 +17,7 @@ static uint32_t   lastEdgeMs     = 0;
 static uint32_t   pressStartMs   = 0;
 static uint8_t    shortPressCnt  = 0;
 static uint32_t   lastReleaseMs  = 0;
+static bool       restartPending = false;   // after the erase blinks
 
 // ────────────────────────────────────────────────────────────
 void setupButton() {
@@ -25,7 +27,10 @@ void setupButton() {
 // ----‑‑ helpers ------------------------------------------------------
 static void actionShort() {
   Serial.println("Button: Short clicked");
-  if (currentMode == MODE_RUNNING || currentMode == MODE_STARTUP) {
+  if (currentMode == MODE_FAULT) {
+    Serial.println("Button: Clearing fault");
+    clearFault();                 // to idle, a second click starts
+  } else if (currentMode == MODE_RUNNING || currentMode == MODE_STARTUP) {
     Serial.println("Button: Triggering shutdown mode");
     enterMode(MODE_SHUTDOWN);     // stop
   } else {
@@ -36,14 +41,13 @@ static void actionShort() {
 
 static void actionLong() {
   Serial.println("Button: Long click");
-  // five red blinks then NVS erase + reboot
-  for (int i = 0; i < 5; ++i) { setLED(255,0,0); delay(150); setLED(0,0,0); delay(150); }
-
+  // NVS erase, five red blinks, reboot once they have played
   Preferences p;
   p.begin("cpap", false);
   p.clear();
   p.end();
-  esp_restart();
+  seqPlay(SEQ_ERASE);
+  restartPending = true;
 }
 
 static void actionTriple() {
@@ -55,6 +59,10 @@ static void actionTriple() {
 
 // ────────────────────────────────────────────────────────────
 void pollButton() {
+  if (restartPending) {
+    if (!seqBusy()) esp_restart();
+    return;
+  }
   uint32_t now   = millis();
   bool     level = digitalRead(BTN_PIN);   // HIGH = released, LOW = pressed
 
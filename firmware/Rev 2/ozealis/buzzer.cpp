@@ -1,4 +1,5 @@
 #include "buzzer.h"
+#include "sequencer.h"
 
 // ── Buzzer handling ──
 void setupBuzzer() {
@@ -8,7 +9,9 @@ void setupBuzzer() {
 
 void buzz(uint16_t ms) {
   Serial.println("Buzzer: playing");
-  digitalWrite(BZR_SIG, HIGH);
-  delay(ms);
-  digitalWrite(BZR_SIG, LOW);
+  seqPlay(SeqPattern{ 1, ms, 0, true, SEQ_NO_LED, SEQ_INFO });
+}
+
+void buzzerSet(bool on) {
+  digitalWrite(BZR_SIG, on ? HIGH : LOW);
 }
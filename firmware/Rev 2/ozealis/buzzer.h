@@ -6,6 +6,7 @@
 #define BZR_SIG 27
 
 void setupBuzzer();
-void buzz(uint16_t duration_ms);
+void buzz(uint16_t duration_ms);   // non‑blocking, plays through sequencer.h
+void buzzerSet(bool on);           // raw pin, for the sequencer
 
 #endif
@@ -0,0 +1,116 @@
+// cardio.cpp – implementation
+#include "cardio.h"
+#include "sensor.h"  // sensorSampleRateHz()
+#include <math.h>
+
+static uint8_t  decim = 5;           // flow samples per decimated sample
+static float    fd = CARDIO_FS_HZ;   // decimated rate
+static uint8_t  lagMin = 6, lagMax = 22;
+
+static float    acc = 0.0f;
+static uint8_t  nAcc = 0;
+static float    hp = 0.0f;           // slow mean, removed
+static bool     haveHp = false;
+
+// current stretch
+static float    ring[CARDIO_MAX_LAG];
+static uint8_t  head = 0;
+static uint16_t n = 0;
+static float    R[CARDIO_MAX_LAG + 1];
+static float    R0 = 0.0f;
+static bool     quiet = false;
+static uint8_t  quietS = 0;
+
+static CardioResult best{};
+
+static void clearStretch() {
+  for (uint8_t l = 0; l <= CARDIO_MAX_LAG; ++l) R[l] = 0.0f;
+  R0 = 0.0f;
+  n = 0;
+  head = 0;
+  quietS = 0;
+}
+
+static CardioResult evaluate() {
+  CardioResult c{};
+  if (quietS < CARDIO_MIN_S || n <= lagMax || R0 <= 0.0f) return c;
+  c.valid = true;
+  c.dur_s = quietS;
+  c.rms_Lpm = sqrtf(R0 / n);
+
+  // local maximum of r[lag] = R[lag]/R0 inside the heart rate band; the
+  // rate comes from the first peak over the threshold, the ones at two and
+  // three beats can be higher when a beat is a fractional number of lags
+  bool rateFixed = false;
+  for (uint8_t l = lagMin; l <= lagMax; ++l) {
+    const float r = R[l] / R0;
+    const float rl = R[l - 1] / R0, rr = R[l + 1] / R0;
+    if (!(r >= rl && r >= rr)) continue;
+    if (r > c.r) {
+      c.r = r;
+      if (!rateFixed) c.hr_bpm = 60.0f * fd / l;
+    }
+    if (r >= CARDIO_R_TH) rateFixed = true;
+  }
+  c.oscillating = c.r >= CARDIO_R_TH;
+  return c;
+}
+
+static void endStretch() {
+  const CardioResult c = evaluate();
+  if (c.valid && c.dur_s >= best.dur_s) best = c;
+  clearStretch();
+}
+
+// ------------------------------------------------
+void cardioBegin() {
+  const uint16_t fs = sensorSampleRateHz();
+  decim = (uint8_t)max(1L, lroundf(fs / CARDIO_FS_HZ));
+  fd = (float)fs / decim;
+  lagMin = (uint8_t)max(2L, lroundf(fd / CARDIO_HR_MAX_HZ));
+  lagMax = (uint8_t)min<long>(CARDIO_MAX_LAG - 1, lroundf(fd / CARDIO_HR_MIN_HZ));
+  clearStretch();
+  best = CardioResult{};
+}
+
+void cardioAdd(float q) {
+  acc += q;
+  if (++nAcc < decim) return;
+  const float d = acc / nAcc;
+  acc = 0.0f;
+  nAcc = 0;
+
+  if (!haveHp) { hp = d; haveHp = true; }
+  hp += (1.0f / (fd * CARDIO_HP_TAU_S)) * (d - hp);
+  if (!quiet) return;
+  const float x = d - hp;
+
+  // ring[head − l] is the sample l back; one lag either side for the peak test
+  const uint8_t hi = (uint8_t)min<uint16_t>(n, lagMax + 1);
+  for (uint8_t l = lagMin - 1; l <= hi; ++l)
+    R[l] += x * ring[(head + CARDIO_MAX_LAG - l) % CARDIO_MAX_LAG];
+  R0 += x * x;
+  ring[head] = x;
+  head = (head + 1) % CARDIO_MAX_LAG;
+  if (n < 0xFFFF) n++;
+}
+
+void cardioBlock(bool q) {
+  if (q) {
+    quiet = true;
+    if (quietS < 0xFF) quietS++;
+  } else {
+    if (quiet) endStretch();
+    quiet = false;
+  }
+}
+
+CardioResult cardioTake() {
+  if (quiet) {
+    const CardioResult c = evaluate();
+    if (c.valid && c.dur_s >= best.dur_s) best = c;
+  }
+  const CardioResult c = best;
+  best = CardioResult{};
+  return c;
+}
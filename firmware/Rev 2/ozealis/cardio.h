@@ -0,0 +1,39 @@
+// cardio.h – cardiogenic oscillations during apneas, open vs closed airway
+#ifndef CARDIO_H
+#define CARDIO_H
+
+#include <Arduino.h>
+
+/*  With the airway open, each heartbeat pushes a little air in and out of
+    the lungs, so during a central apnea the flow carries a small periodic
+    ripple at the heart rate. Behind a closed airway it doesn't.
+    Respiratory flow (breath.h) is boxcar decimated to ~CARDIO_FS_HZ, high
+    passed, and during each quiet stretch (1 s apnea blocks under the apnea
+    threshold) the autocorrelation is accumulated for the lags of
+    CARDIO_HR_MIN..MAX, one MAC per lag per decimated sample, into fixed
+    arrays. The stretch is oscillating when the normalised autocorrelation
+    has a local peak ≥ CARDIO_R_TH in that range.                          */
+
+constexpr float   CARDIO_FS_HZ     = 15.0f;
+constexpr float   CARDIO_HR_MIN_HZ = 0.7f;    // 42 bpm
+constexpr float   CARDIO_HR_MAX_HZ = 2.5f;    // 150 bpm
+constexpr uint8_t CARDIO_MAX_LAG   = 32;      // ring size, ≥ fs / HR_MIN
+constexpr float   CARDIO_HP_TAU_S  = 1.0f;
+constexpr float   CARDIO_R_TH      = 0.35f;
+constexpr uint8_t CARDIO_MIN_S     = 8;       // shortest stretch worth classifying
+
+struct CardioResult {
+  bool    valid;        // a stretch of at least CARDIO_MIN_S was seen
+  bool    oscillating;  // open airway
+  float   r;            // peak normalised autocorrelation
+  float   hr_bpm;       // at the peak lag, 0 if none
+  float   rms_Lpm;      // of the filtered flow
+  uint8_t dur_s;
+};
+
+void cardioBegin();                 // after setupSensors(), reads the ODR
+void cardioAdd(float resp_Lpm);     // every flow sample
+void cardioBlock(bool quiet);       // per 1 s apnea block; false ends the stretch
+CardioResult cardioTake();          // longest stretch since the last take, then cleared
+
+#endif  // CARDIO_H
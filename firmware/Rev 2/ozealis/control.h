@@ -0,0 +1,27 @@
+// control.h – fixed-rate control task (acquisition, safety, papLoop)
+// Implemented in logic.cpp next to the UI half, runMainLogic().
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <Arduino.h>
+
+constexpr uint16_t CONTROL_HZ_MIN     = 100;
+constexpr uint16_t CONTROL_HZ_MAX     = 250;
+constexpr uint16_t CONTROL_HZ_DEFAULT = 200;
+constexpr uint8_t  CONTROL_TASK_PRIO  = 5;  // above vin_adc (2) and loop() (1), core 1
+
+struct ControlStats {
+  uint16_t hz;          // effective rate, whole RTOS ticks per period
+  uint32_t periods;
+  uint32_t overruns;    // step took longer than one period
+  uint32_t maxLate_us;  // wake-up behind schedule, since controlStatsReset()
+  float    avgLate_us;
+  uint32_t maxExec_us;  // since controlStatsReset()
+};
+
+void controlBegin(uint16_t hz);     // start the task, after all setup*()
+void controlSetRate(uint16_t hz);   // clamped, applied at the next period
+const ControlStats& controlGetStats();
+void controlStatsReset();           // clears the max fields
+
+#endif  // CONTROL_H
@@ -1,20 +1,106 @@
 #include "datalog.h"
-#include <string>
-static CircularBuffer<String, 600> buf;  // 10 min @1 Hz  ≈ 2.6 kB
+#include <freertos/FreeRTOS.h>
+
+struct DlBreath {
+  uint16_t ti_ms, te_ms;
+  int16_t  peakI_x10, peakE_x10;   // L/min × 10
+  uint16_t vt_mL, detLat_ms, trigLat_ms;
+  uint16_t vib_x10;
+  uint8_t  flatPct, flags;          // bit0 flow limited, bit1 flutter, bit2 snore
+};
+
+struct DlEvent {
+  uint16_t dur_s;
+  uint8_t  type, minPct, airway, hrBpm;
+};
+
+struct DlRecord {
+  uint32_t ms;
+  uint8_t  kind;   // 'B' or 'E'
+  union {
+    DlBreath b;
+    DlEvent  e;
+  };
+};
+static_assert(sizeof(DlRecord) <= 24, "datalog record grew past its RAM budget");
+
+static DlRecord ring[DL_RECORDS];
+static uint32_t pushed = 0;    // records ever pushed since dl_init()
+static uint32_t cursor = 0;    // next record to page out
+static portMUX_TYPE dlMux = portMUX_INITIALIZER_UNLOCKED;   // loop() pushes, BLE reads
+
+static int16_t x10(float v) { return (int16_t)constrain(lroundf(v * 10.0f), -32768L, 32767L); }
+
+static void push(const DlRecord& r) {
+  portENTER_CRITICAL(&dlMux);
+  ring[pushed % DL_RECORDS] = r;
+  pushed++;
+  portEXIT_CRITICAL(&dlMux);
+}
 
 void dl_init() {
-  buf.clear();
+  portENTER_CRITICAL(&dlMux);
+  pushed = cursor = 0;
+  portEXIT_CRITICAL(&dlMux);
+}
+
+void dl_pushBreath(uint32_t ms, const BreathRecord& r) {
+  DlRecord d{};
+  d.ms = ms;
+  d.kind = 'B';
+  d.b.ti_ms = r.ti_ms;
+  d.b.te_ms = r.te_ms;
+  d.b.peakI_x10 = x10(r.peakInsp_Lpm);
+  d.b.peakE_x10 = x10(r.peakExp_Lpm);
+  d.b.vt_mL = (uint16_t)constrain(lroundf(r.vt_mL), 0L, 65535L);
+  d.b.detLat_ms = r.detLat_ms;
+  d.b.trigLat_ms = r.trigLat_ms;
+  d.b.vib_x10 = (uint16_t)constrain(lroundf(r.vibIdx * 10.0f), 0L, 65535L);
+  d.b.flatPct = r.flatPct;
+  d.b.flags = (r.flowLimited ? 1 : 0) | (r.flutter ? 2 : 0) | (r.snore ? 4 : 0);
+  push(d);
 }
 
-void dl_push(const char* line) {
-  if (buf.isFull()) buf.shift();
-  buf.push(String(line));
+void dl_pushEvent(const ApneaEvent& e) {
+  DlRecord d{};
+  d.ms = e.start_ms;
+  d.kind = 'E';
+  d.e.dur_s = e.dur_s;
+  d.e.type = (uint8_t)e.type;
+  d.e.minPct = e.minPct;
+  d.e.airway = (uint8_t)e.airway;
+  d.e.hrBpm = e.hrBpm;
+  push(d);
 }
+
 std::string dl_getCsv() {
   std::string out;
-  for (size_t i = 0; i < buf.size(); ++i) {
-    out += buf[i].c_str();
-    out += "\n";
+  out.reserve(DL_PAGE_BYTES);
+  char line[96];
+  for (;;) {
+    DlRecord r;
+    portENTER_CRITICAL(&dlMux);
+    if (pushed - cursor > DL_RECORDS) cursor = pushed - DL_RECORDS;   // overwritten while paging
+    const bool more = cursor < pushed;
+    if (more) r = ring[cursor % DL_RECORDS];
+    portEXIT_CRITICAL(&dlMux);
+    if (!more) break;
+
+    int n;
+    if (r.kind == 'B') {
+      n = snprintf(line, sizeof(line), "B,%lu,%u,%u,%.1f,%.1f,%u,%u,%u,%u,%u,%d,%.1f,%u\n",
+                   (unsigned long)r.ms, r.b.ti_ms, r.b.te_ms, r.b.peakI_x10 / 10.0f, r.b.peakE_x10 / 10.0f,
+                   r.b.vt_mL, r.b.detLat_ms, r.b.flatPct, r.b.flags & 1, (r.b.flags >> 1) & 1,
+                   r.b.trigLat_ms == 0xFFFF ? -1 : (int)r.b.trigLat_ms, r.b.vib_x10 / 10.0f, (r.b.flags >> 2) & 1);
+    } else {
+      n = snprintf(line, sizeof(line), "E,%lu,%u,%u,%u,%u,%u\n", (unsigned long)r.ms, r.e.dur_s, r.e.type,
+                   r.e.minPct, r.e.airway, r.e.hrBpm);
+    }
+    if (out.size() + n > DL_PAGE_BYTES) break;
+    out += line;
+    cursor++;
   }
+  // an empty page ends the download, the next one starts over
+  if (out.empty()) cursor = pushed > DL_RECORDS ? pushed - DL_RECORDS : 0;
   return out;
 }
@@ -1,11 +1,25 @@
 #ifndef DATALOG_H
 #define DATALOG_H
 #include <Arduino.h>
-#include <CircularBuffer.hpp>
 #include <string>
+#include "breath.h"  // BreathRecord
+#include "apnea.h"   // ApneaEvent
+
+/*  Completed breaths and events are kept as fixed 24 byte binary records in
+    a ring of DL_RECORDS (12 kB, ~30 min of breaths), no heap. They are
+    formatted to CSV only when read, one page of at most DL_PAGE_BYTES per
+    BLE read, oldest first; a read past the newest record returns "" and the
+    next read starts over from the oldest. Lines:
+      B,ms,Ti,Te,peakI,peakE,Vt,latency,flat%,FL,flutter,trigLat,vib,snore   one per breath (trigLat -1 = none)
+      E,startMs,dur_s,type,minPct,airway,hr                one per apnea (0) / hypopnea (1),
+                                                           airway 0 unknown, 1 open (central), 2 closed */
+
+constexpr uint16_t DL_RECORDS    = 512;
+constexpr uint16_t DL_PAGE_BYTES = 2048;
 
 void dl_init();
-void dl_push(const char* csvLine);  // call every second
-std::string dl_getCsv();            // whole log as string
+void dl_pushBreath(uint32_t ms, const BreathRecord& r);
+void dl_pushEvent(const ApneaEvent& e);
+std::string dl_getCsv();            // next page, "" once the newest has been read
 
 #endif
@@ -1,5 +1,6 @@
 // diag.cpp
 #include "diag.h"
+#include "span.h"
 
 static CircularBuffer<FaultSnapshot, 32> s_faults;  // last 32 faults in RAM
 static uint16_t s_loop_us = 0;
@@ -16,6 +17,9 @@ void diag_note_loop_us(uint16_t us) {
 void diag_capture_fault(const FaultSnapshot& in) {
   FaultSnapshot s = in;
   s.loop_us = s_loop_us;
+  const SpanStats ctl = spanGet(SPAN_CTL);
+  s.ctlP99_us = (uint16_t)min<uint32_t>(65000, ctl.p99_us);
+  s.ctlMax_us = (uint16_t)min<uint32_t>(65000, ctl.max_us);
   if (s_faults.isFull()) s_faults.shift();
   s_faults.push(s);
 }
@@ -23,15 +27,15 @@ void diag_capture_fault(const FaultSnapshot& in) {
 String diag_fault_csv() {
   String out;
   out.reserve(1024);
-  out += "ts_ms,sys_mode,fault,vin_V,pMask_hPa,pBlower_hPa,ambient_hPa,diff_hPa,setpoint_cm,flowProxy_hPa,motorAmp,loop_us,miss1,miss2,i2cErr1,i2cErr2\n";
+  out += "ts_ms,sys_mode,fault,vin_V,pMask_hPa,pBlower_hPa,ambient_hPa,diff_hPa,setpoint_cm,flowProxy_hPa,motorAmp,estMask_hPa,estConf,loop_us,ctlP99_us,ctlMax_us,miss1,miss2,i2cErr1,i2cErr2\n";
   for (size_t i = 0; i < s_faults.size(); ++i) {
     const auto& s = s_faults[i];
     char line[256];
     snprintf(line, sizeof(line),
-      "%lu,%u,%u,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%u,%u,%u,%u,%d,%d\n",
+      "%lu,%u,%u,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%u,%.2f,%.2f,%u,%u,%u,%u,%u,%d,%d\n",
       (unsigned long)s.ts_ms, s.sys_mode, s.fault_code, s.vin_V,
       s.pMask_hPa, s.pBlower_hPa, s.ambient_hPa, s.diff_hPa,
-      s.setpoint_cm, s.flowProxy_hPa, s.motorAmp, s.loop_us,
+      s.setpoint_cm, s.flowProxy_hPa, s.motorAmp, s.estMask_hPa, s.estConf, s.loop_us, s.ctlP99_us, s.ctlMax_us,
       s.miss1, s.miss2, s.i2cErr1, s.i2cErr2);
     out += line;
   }
@@ -18,7 +18,11 @@ struct FaultSnapshot {
   float    setpoint_cm;    // pap setpoint at time of fault
   float    flowProxy_hPa;  // pap flow proxy
   uint8_t  motorAmp;       // PWM amplitude 0..255
+  float    estMask_hPa;    // estimator mask gauge
+  float    estConf;        // estimator confidence 0..1
   uint16_t loop_us;        // last loop time
+  uint16_t ctlP99_us;      // control step p99 since spanReset()
+  uint16_t ctlMax_us;      // control step max since spanReset()
   // Sensor-level diagnostics
   uint16_t miss1;          // consecutive misses sensor1
   uint16_t miss2;          // consecutive misses sensor2
@@ -0,0 +1,181 @@
+// estimator.cpp – implementation
+#include "estimator.h"
+#include "motor.h"  // bemfEdges
+#include <math.h>
+
+static bool  estInit = false;
+static float x[2] = { 0.0f, 0.0f };          // Pb, d
+static float P[2][2] = { { 1, 0 }, { 0, 1 } };
+static uint32_t lastUs = 0;
+
+// slowly learned model parameters
+static float kFan = 0.5f;      // hPa per (k edges/s)²
+static float hoseFrac = 0.1f;  // d / Pb at steady vent flow
+
+// model residual variances, characterised while both sensors are valid
+static float fanResVar  = 0.25f;  // hPa², zb vs fan curve
+static float hoseResVar = 1.0f;   // hPa², d vs hoseFrac·Pb (mostly breathing)
+static uint32_t lastZbUs = 0, lastZmUs = 0;
+
+// fan load: edges/s per amplitude count at normal airway load
+static float    kSpeed = 0.0f;
+static float    loadRatio = 0.0f;
+static uint32_t obstructSinceMs = 0;
+static bool     obstructed = false;
+
+// fan speed from BEMF edge rate
+static uint32_t edgeLast = 0, edgeLastUs = 0;
+static float edgeRate = 0.0f;  // edges/s, smoothed
+
+static void updateEdgeRate(uint32_t now_us) {
+  const uint32_t dt_us = now_us - edgeLastUs;
+  if (dt_us < 20000) return;
+  const uint32_t e = bemfEdges;
+  const float inst = (e - edgeLast) * 1e6f / dt_us;
+  edgeLast = e;
+  edgeLastUs = now_us;
+  const float a = min(1.0f, dt_us / 200000.0f);  // ~200 ms smoothing
+  edgeRate += a * (inst - edgeRate);
+  if (motorGetAmplitude() == 0 && !motorIsStarting()) edgeRate = 0.0f;
+}
+
+static void predict(float dt) {
+  const float ke = edgeRate * 1e-3f;
+  const float a  = expf(-dt / EST_TAU_FAN_S);
+  const float r  = expf(-dt / EST_TAU_HOSE_S);
+  const float c  = (1.0f - r) * hoseFrac;
+
+  // F = [[a, 0], [c·a, r]] with d driven by the predicted Pb
+  const float pb = a * x[0] + (1.0f - a) * kFan * ke * ke;
+  const float d  = r * x[1] + c * pb;
+  x[0] = pb; x[1] = d;
+
+  const float F00 = a, F10 = c * a, F11 = r;
+  const float p00 = F00 * F00 * P[0][0];
+  const float p01 = F00 * (F10 * P[0][0] + F11 * P[0][1]);
+  const float p11 = F10 * F10 * P[0][0] + 2.0f * F10 * F11 * P[0][1] + F11 * F11 * P[1][1];
+  P[0][0] = p00 + EST_Q_PB * dt;
+  P[0][1] = P[1][0] = p01;
+  P[1][1] = p11 + EST_Q_D * dt;
+}
+
+// scalar update with z = h0·Pb + h1·d
+static void correct(float z, float h0, float h1) {
+  const float Ph0 = P[0][0] * h0 + P[0][1] * h1;
+  const float Ph1 = P[1][0] * h0 + P[1][1] * h1;
+  const float S = h0 * Ph0 + h1 * Ph1 + EST_R_SENSOR;
+  const float k0 = Ph0 / S, k1 = Ph1 / S;
+  const float e = z - (h0 * x[0] + h1 * x[1]);
+  x[0] += k0 * e;
+  x[1] += k1 * e;
+  const float p00 = P[0][0] - k0 * Ph0;
+  const float p01 = P[0][1] - k0 * Ph1;
+  const float p11 = P[1][1] - k1 * Ph1;
+  P[0][0] = p00; P[0][1] = P[1][0] = p01; P[1][1] = p11;
+}
+
+// ------------------------------------------------
+void estBegin() {
+  estInit = false;
+  x[0] = x[1] = 0.0f;
+  P[0][0] = P[1][1] = 1.0f; P[0][1] = P[1][0] = 0.0f;
+  edgeLast = bemfEdges;
+  edgeLastUs = micros();
+  edgeRate = 0.0f;
+}
+
+void estUpdate(const PressureSample* s, uint8_t n, float ambient) {
+  const uint32_t now_us = micros();
+  updateEdgeRate(now_us);
+  if (!isfinite(ambient)) return;
+
+  for (uint8_t i = 0; i < n; ++i) {
+    const float zb = s[i].pBlower_hPa - ambient;
+    const float zm = s[i].pMask_hPa - ambient;
+
+    if (!estInit) {
+      if (!isfinite(zb) || !isfinite(zm)) continue;
+      x[0] = zb; x[1] = zb - zm;
+      P[0][0] = P[1][1] = EST_R_SENSOR; P[0][1] = P[1][0] = 0.0f;
+      lastUs = s[i].t_us;
+      estInit = true;
+      continue;
+    }
+
+    const float dt = constrain((int32_t)(s[i].t_us - lastUs) * 1e-6f, 0.0f, 0.5f);
+    lastUs = s[i].t_us;
+    predict(dt);
+    if (isfinite(zb)) { correct(zb, 1.0f, 0.0f); lastZbUs = s[i].t_us; }
+    if (isfinite(zm)) { correct(zm, 1.0f, -1.0f); lastZmUs = s[i].t_us; }
+
+    // adapt the fan and hose gains, and their residuals, from full pairs only
+    if (isfinite(zb) && isfinite(zm)) {
+      const float ke = edgeRate * 1e-3f;
+      if (ke > 0.5f) {
+        const float r = zb - kFan * ke * ke;
+        fanResVar += 0.002f * (r * r - fanResVar);
+        kFan += 0.002f * (zb / (ke * ke) - kFan);
+      }
+      if (zb > 2.0f) {
+        const float r = (zb - zm) - hoseFrac * zb;
+        hoseResVar += 0.002f * (r * r - hoseResVar);
+        hoseFrac += 0.0005f * ((zb - zm) / zb - hoseFrac);
+      }
+      const uint8_t amp = motorGetAmplitude();
+      // slow (~2 min) and frozen while loaded abnormally, so an obstruction is not learned away
+      if (amp > 40 && edgeRate > 100.0f && loadRatio < 1.05f) {
+        const float k = edgeRate / amp;
+        kSpeed = kSpeed > 0.0f ? kSpeed + 0.0001f * (k - kSpeed) : k;
+      }
+    }
+  }
+
+  // load check once per call: fan faster than expected at this amplitude
+  const uint8_t amp = motorGetAmplitude();
+  loadRatio = (kSpeed > 0.0f && amp > 40) ? edgeRate / (kSpeed * amp) : 0.0f;
+  const uint32_t nowMs = millis();
+  if (loadRatio > EST_OBSTRUCT_RATIO) {
+    if (!obstructSinceMs) obstructSinceMs = nowMs;
+    obstructed = nowMs - obstructSinceMs >= EST_OBSTRUCT_MS;
+  } else {
+    obstructSinceMs = 0;
+    obstructed = false;
+  }
+
+  // no slot this call: coast on the model so σ grows while sensors are silent
+  if (estInit && n == 0 && now_us - lastUs > 20000) {
+    predict(min(0.5f, (now_us - lastUs) * 1e-6f));
+    lastUs = now_us;
+  }
+}
+
+bool  estValid()           { return estInit; }
+float estBlowerGauge_hPa() { return estInit ? x[0] : NAN; }
+float estDiff_hPa()        { return estInit ? x[1] : NAN; }
+float estMaskGauge_hPa()   { return estInit ? x[0] - x[1] : NAN; }
+float estFanEdgeRate()     { return edgeRate; }
+
+float estMaskSigma_hPa() {
+  if (!estInit) return NAN;
+  return sqrtf(max(0.0f, P[0][0] - 2.0f * P[0][1] + P[1][1]));
+}
+
+float estMaskErrBound_hPa() {
+  if (!estInit) return NAN;
+  const float sm = estMaskSigma_hPa();
+  const uint32_t now_us = micros();
+  float var = sm * sm;
+  if (now_us - lastZmUs > 100000) var += hoseResVar;  // mask side from the hose/vent model
+  if (now_us - lastZbUs > 100000) var += fanResVar;   // blower side from the fan curve
+  return 3.0f * sqrtf(var);
+}
+
+float estLoadRatio() { return loadRatio; }
+bool  estAirwayObstructed() { return obstructed; }
+
+float estConfidence() {
+  if (!estInit) return 0.0f;
+  const float s2 = EST_SIGMA_REF * EST_SIGMA_REF;
+  const float sm = estMaskSigma_hPa();
+  return s2 / (s2 + sm * sm);
+}
@@ -0,0 +1,44 @@
+// estimator.h – 2‑state Kalman filter for blower/mask gauge pressure
+#ifndef ESTIMATOR_H
+#define ESTIMATOR_H
+
+#include <Arduino.h>
+#include "sensor.h"
+
+/*  State x = [Pb, d]: blower gauge pressure and baffle drop (Pb − Pm), hPa.
+    Pb  relaxes toward the fan curve Kfan·(edge rate)² with time constant EST_TAU_FAN_S.
+    d   relaxes toward hoseFrac·Pb, the steady vent‑flow drop of the hose/mask,
+        breathing is the random‑walk deviation from it.
+    Each aligned FIFO pair gives zb = Pb and zm = Pb − d; a failed sensor (NAN)
+    simply contributes no update, so its side is carried by the model and the
+    confidence decays instead of a stale value being re‑used.               */
+
+constexpr float EST_TAU_FAN_S   = 0.15f;  // blower + plenum pressure lag
+constexpr float EST_TAU_HOSE_S  = 2.0f;   // d mean reversion
+constexpr float EST_Q_PB        = 0.25f;  // hPa²/s fan model uncertainty
+constexpr float EST_Q_D         = 1.0f;   // hPa²/s breathing drive
+constexpr float EST_R_SENSOR    = 0.001f; // hPa² per LPS22 sample
+constexpr float EST_SIGMA_REF   = 0.3f;   // hPa, confidence 0.5 at this σ
+
+// Airway obstruction: a blocked hose unloads the fan, so at a given amplitude
+// the BEMF edge rate rises above what the learned speed/amplitude gain predicts.
+constexpr float    EST_OBSTRUCT_RATIO = 1.15f;
+constexpr uint32_t EST_OBSTRUCT_MS    = 10000;
+
+void  estBegin();
+void  estUpdate(const PressureSample* s, uint8_t n, float ambient_hPa);  // per acquisition
+bool  estValid();             // initialised from at least one full pair
+float estMaskGauge_hPa();     // Pm = Pb − d
+float estBlowerGauge_hPa();   // Pb
+float estDiff_hPa();          // d, fused flow proxy
+float estMaskSigma_hPa();     // 1σ of Pm
+float estConfidence();        // 0..1 from σ(Pm)
+float estFanEdgeRate();       // BEMF edges/s driving the fan model
+
+// Single-sensor operation: 3σ bound on Pm including the characterised
+// residual of whichever model (fan curve or hose/vent) replaces the lost sensor.
+float estMaskErrBound_hPa();
+float estLoadRatio();         // edge rate / expected at this amplitude, 0 if unknown
+bool  estAirwayObstructed();  // load ratio above threshold for EST_OBSTRUCT_MS
+
+#endif  // ESTIMATOR_H
@@ -0,0 +1,174 @@
+// flowcal.cpp – implementation
+#include "flowcal.h"
+#include <Preferences.h>
+#include <math.h>
+
+static FlowCal cal;  // live coefficients
+static Preferences calPrefs;  // NVS namespace "cal", survives settings reset
+
+// ========= guided run state =========
+static volatile FlowCalState state = FLOWCAL_IDLE;   // stepped in the control task
+static uint8_t  step = 0;
+static uint32_t stepStartMs = 0;
+static float    dpSum = 0.0f;
+static uint16_t dpCount = 0;
+static volatile float pendingRef = NAN;  // written from BLE task
+
+// collected points for the fit report
+static float ptDiff[FLOWCAL_STEPS];
+static float ptRef[FLOWCAL_STEPS];
+
+static inline float sgnSqrt(float d) {
+  return d >= 0.0f ? sqrtf(d) : -sqrtf(-d);
+}
+
+// ------------------------------------------------
+void flowBegin() {
+  calPrefs.begin("cal", true);
+  cal.valid = calPrefs.getBool("flowOk", false);
+  if (cal.valid) {
+    cal.kSqrt = calPrefs.getFloat("flowKs", cal.kSqrt);
+    cal.kLin  = calPrefs.getFloat("flowKl", cal.kLin);
+  }
+  calPrefs.end();
+  Serial.printf("Flow: %s kSqrt=%.2f kLin=%.2f\n",
+                cal.valid ? "calibrated" : "nominal", cal.kSqrt, cal.kLin);
+}
+
+static void saveCal() {
+  calPrefs.begin("cal", false);
+  calPrefs.putFloat("flowKs", cal.kSqrt);
+  calPrefs.putFloat("flowKl", cal.kLin);
+  calPrefs.putBool("flowOk", cal.valid);
+  calPrefs.end();
+}
+
+float flowFromDiff_Lpm(float d) {
+  if (!isfinite(d)) return NAN;
+  return cal.kSqrt * sgnSqrt(d) + cal.kLin * d;
+}
+
+const FlowCal& flowGetCal() { return cal; }
+
+void flowResetCal() {
+  cal = FlowCal{};
+  calPrefs.begin("cal", false);
+  calPrefs.remove("flowKs");
+  calPrefs.remove("flowKl");
+  calPrefs.remove("flowOk");
+  calPrefs.end();
+}
+
+// ------------------------------------------------
+// least squares on Q = a·s + b·d with s = sgn(d)√|d|; the model passes
+// through the origin so the no‑flow point is implicit
+static bool fitAndSave(uint8_t n) {
+  float Sss = 0, Ssd = 0, Sdd = 0, SsQ = 0, SdQ = 0;
+  for (uint8_t i = 0; i < n; ++i) {
+    const float s = sgnSqrt(ptDiff[i]);
+    const float d = ptDiff[i];
+    Sss += s * s; Ssd += s * d; Sdd += d * d;
+    SsQ += s * ptRef[i]; SdQ += d * ptRef[i];
+  }
+  if (Sss <= 0.0f) return false;
+
+  float a, b;
+  const float det = Sss * Sdd - Ssd * Ssd;
+  if (n >= 3 && fabsf(det) > 1e-6f * Sss * Sdd) {
+    a = (SsQ * Sdd - SdQ * Ssd) / det;
+    b = (Sss * SdQ - Ssd * SsQ) / det;
+  } else {
+    a = SsQ / Sss;  // square‑root law only
+    b = 0.0f;
+  }
+  // the curve must stay monotonic over the calibrated range
+  if (!(a > 0.0f) || !isfinite(b)) return false;
+  for (uint8_t i = 0; i < n; ++i) {
+    if (b < 0.0f && a * 0.5f / sqrtf(fabsf(ptDiff[i]) + 1e-3f) + b <= 0.0f) return false;
+  }
+
+  cal.kSqrt = a;
+  cal.kLin  = b;
+  cal.valid = true;
+  saveCal();
+
+  Serial.printf("Flow: fit kSqrt=%.3f kLin=%.3f\n", a, b);
+  for (uint8_t i = 0; i < n; ++i) {
+    Serial.printf("Flow:  dP=%.3f ref=%.1f fit=%.1f L/min\n",
+                  ptDiff[i], ptRef[i], flowFromDiff_Lpm(ptDiff[i]));
+  }
+  return true;
+}
+
+// ------------------------------------------------
+void flowCalStart() {
+  step = 0;
+  dpSum = 0.0f; dpCount = 0;
+  pendingRef = NAN;
+  stepStartMs = millis();
+  state = FLOWCAL_SETTLING;
+  Serial.println("Flow: calibration started");
+}
+
+void flowCalAbort() {
+  if (!flowCalActive()) return;
+  state = FLOWCAL_IDLE;
+  Serial.println("Flow: calibration aborted");
+}
+
+bool flowCalActive() {
+  return state == FLOWCAL_SETTLING || state == FLOWCAL_SAMPLING;
+}
+
+FlowCalState flowCalState() { return state; }
+uint8_t flowCalStep() { return step; }
+
+float flowCalSetpointCm() {
+  return FLOWCAL_CM_LO + (FLOWCAL_CM_HI - FLOWCAL_CM_LO) * step / (FLOWCAL_STEPS - 1);
+}
+
+bool flowCalReference(float ref_Lpm) {
+  if (state != FLOWCAL_SAMPLING || !isfinite(ref_Lpm)) return false;
+  pendingRef = ref_Lpm;
+  return true;
+}
+
+void flowCalService(float diff_hPa) {
+  if (!flowCalActive()) return;
+
+  if (state == FLOWCAL_SETTLING) {
+    if (millis() - stepStartMs < FLOWCAL_SETTLE_MS) return;
+    state = FLOWCAL_SAMPLING;
+    Serial.printf("Flow: step %u/%u at %.1f cm, enter reference flow\n",
+                  step + 1, FLOWCAL_STEPS, flowCalSetpointCm());
+  }
+
+  if (isfinite(diff_hPa) && dpCount < 0xFFFF) {
+    dpSum += diff_hPa;
+    dpCount++;
+  }
+
+  const float ref = pendingRef;
+  if (isnan(ref) || dpCount == 0) return;
+  pendingRef = NAN;
+
+  ptDiff[step] = dpSum / dpCount;
+  ptRef[step]  = ref;
+  dpSum = 0.0f; dpCount = 0;
+
+  if (++step < FLOWCAL_STEPS) {
+    stepStartMs = millis();
+    state = FLOWCAL_SETTLING;
+    return;
+  }
+  state = FLOWCAL_FITTING;
+}
+
+// the NVS write and the report stall for milliseconds, so the control task
+// only collects the points and the UI loop finishes the run
+void flowCalFinish() {
+  if (state != FLOWCAL_FITTING) return;
+  const bool ok = fitAndSave(FLOWCAL_STEPS);
+  if (!ok) Serial.println("Flow: fit rejected, keeping previous curve");
+  state = ok ? FLOWCAL_DONE : FLOWCAL_FAILED;
+}
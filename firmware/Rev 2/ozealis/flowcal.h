@@ -0,0 +1,50 @@
+// flowcal.h – baffle ΔP → volumetric flow calibration
+#ifndef FLOWCAL_H
+#define FLOWCAL_H
+
+#include <Arduino.h>
+
+// Model: Q[L/min] = kSqrt · sgn(ΔP)·√|ΔP| + kLin · ΔP   (ΔP = blower − mask, hPa)
+struct FlowCal {
+  float kSqrt = 30.0f;  // turbulent (orifice) term, L/min per √hPa
+  float kLin  = 0.0f;   // laminar term, L/min per hPa
+  bool  valid = false;  // false → nominal coefficients above
+};
+
+// Detection thresholds in L/min. On the nominal curve these equal the
+// former 0.8 hPa / 0.3 hPa proxy thresholds.
+constexpr float FLOW_AUTOSTART_LPM = 26.8f;
+constexpr float FLOW_AUTOSTOP_LPM  = 16.4f;
+
+// Guided run: blower ladder, one reference flow per step
+constexpr uint8_t  FLOWCAL_STEPS     = 6;
+constexpr float    FLOWCAL_CM_LO     = 4.0f;   // first step set‑point
+constexpr float    FLOWCAL_CM_HI     = 18.0f;  // last step set‑point
+constexpr uint32_t FLOWCAL_SETTLE_MS = 3000;   // before ΔP averaging starts
+
+enum FlowCalState : uint8_t {
+  FLOWCAL_IDLE = 0,
+  FLOWCAL_SETTLING,   // blower moving to the step set‑point
+  FLOWCAL_SAMPLING,   // averaging ΔP, waiting for the reference flow
+  FLOWCAL_FITTING,    // all points in, fit and save pending in flowCalFinish()
+  FLOWCAL_DONE,       // last fit succeeded and was saved
+  FLOWCAL_FAILED      // fit rejected, previous coefficients kept
+};
+
+void  flowBegin();                       // load coefficients from NVS
+float flowFromDiff_Lpm(float diff_hPa);  // evaluate model, cheap
+const FlowCal& flowGetCal();
+void  flowResetCal();                    // back to nominal, erases NVS
+
+// Guided calibration (driven from papLoop while active)
+void  flowCalStart();
+void  flowCalAbort();
+bool  flowCalActive();
+void  flowCalService(float diff_hPa);    // call each loop with raw ΔP
+void  flowCalFinish();                   // fit, NVS save and report, from the UI loop
+float flowCalSetpointCm();               // blower target for current step
+bool  flowCalReference(float ref_Lpm);   // record reference for current step
+FlowCalState flowCalState();
+uint8_t flowCalStep();
+
+#endif  // FLOWCAL_H
@@ -0,0 +1,63 @@
+// flowlim.cpp – implementation
+#include "flowlim.h"
+#include <math.h>
+
+static float   buf[FLIM_BUF];
+static uint8_t n = 0;
+static uint8_t stride = 1, skip = 0;  // keep every stride‑th sample
+
+// ------------------------------------------------
+void flimStart() {
+  n = 0;
+  stride = 1;
+  skip = 0;
+}
+
+void flimAdd(float q) {
+  if (++skip < stride) return;
+  skip = 0;
+  if (n == FLIM_BUF) {
+    // full: halve the resolution in place and keep going at half rate
+    for (uint8_t i = 0; i < FLIM_BUF / 2; ++i) buf[i] = buf[2 * i];
+    n = FLIM_BUF / 2;
+    if (stride < 64) stride <<= 1;
+  }
+  buf[n++] = q;
+}
+
+FlowShape flimFinish() {
+  FlowShape s;
+  if (n < FLIM_MIN_PTS) return s;
+
+  float peak = 0.0f, sum = 0.0f;
+  for (uint8_t i = 0; i < n; ++i) {
+    peak = max(peak, buf[i]);
+    sum += buf[i];
+  }
+  if (peak <= 0.0f || sum <= 0.0f) return s;
+
+  // middle half of the inspiration
+  const uint8_t a = n / 4, b = n - n / 4;
+  uint8_t high = 0, kMin = a;
+  for (uint8_t i = a; i < b; ++i) {
+    if (buf[i] >= 0.9f * peak) high++;
+    if (buf[i] < buf[kMin]) kMin = i;
+  }
+  s.flatness = (float)high / (b - a);
+
+  // scooping: the mid‑segment minimum has a higher shoulder on both sides
+  // (on a plain sine the minimum is at an edge, so one side never rises)
+  float early = 0.0f, late = 0.0f;
+  for (uint8_t i = 0; i <= kMin; ++i) early = max(early, buf[i]);
+  for (uint8_t i = kMin; i < n; ++i) late = max(late, buf[i]);
+  s.scoop = buf[kMin] > 0.0f && buf[kMin] < FLIM_SCOOP_TH * min(early, late);
+
+  // vibration: second difference against the mean flow
+  float d2 = 0.0f;
+  for (uint8_t i = 1; i + 1 < n; ++i) d2 += fabsf(buf[i + 1] - 2.0f * buf[i] + buf[i - 1]);
+  s.flutter = (d2 / (n - 2)) / (sum / n);
+
+  s.limited = s.flatness >= FLIM_FLAT_TH || s.scoop;
+  s.valid = true;
+  return s;
+}
@@ -0,0 +1,34 @@
+// flowlim.h – inspiratory flow shape: flattening and flutter per breath
+#ifndef FLOWLIM_H
+#define FLOWLIM_H
+
+#include <Arduino.h>
+
+/*  The inspiratory segment is buffered at the sensor rate into a fixed
+    array; a long inspiration halves the resolution in place instead of
+    growing, so memory and the per‑breath pass are both bounded.
+      flatness  fraction of the middle half of Ti spent at ≥ 90 % of the
+                peak; a half sine gives ~0.58, a plateau → 1
+      scoop     mid‑inspiratory dip below 75 % of a later/earlier peak
+      flutter   mean |Δ²q| / mean q, vibration aliased down from the
+                50‑150 Hz snore band into the FIFO rate                    */
+
+constexpr uint8_t FLIM_BUF       = 128;
+constexpr uint8_t FLIM_MIN_PTS   = 12;     // shorter inspirations are not judged
+constexpr float   FLIM_FLAT_TH   = 0.80f;
+constexpr float   FLIM_SCOOP_TH  = 0.75f;
+constexpr float   FLIM_FLUTTER_TH= 0.12f;
+
+struct FlowShape {
+  float flatness = 0.0f;
+  float flutter  = 0.0f;
+  bool  scoop    = false;
+  bool  limited  = false;   // flat or scooped
+  bool  valid    = false;   // enough points to judge
+};
+
+void flimStart();              // at inspiration onset
+void flimAdd(float q);         // every sample while inspiring, L/min
+FlowShape flimFinish();        // at expiration onset
+
+#endif  // FLOWLIM_H
@@ -0,0 +1,204 @@
+// hose.cpp – implementation
+#include "hose.h"
+#include "flowcal.h"  // flowFromDiff_Lpm()
+#include <Preferences.h>
+#include <math.h>
+
+static HoseModel model;         // live coefficients
+static Preferences hosePrefs;   // NVS namespace "cal"
+
+// per‑sample flow and its derivative
+static bool     haveQ = false;
+static float    qf = 0.0f;      // L/min, smoothed
+static float    dqf = 0.0f;     // L/min/s, smoothed
+static uint32_t lastQUs = 0;
+
+// ========= guided run state =========
+static volatile HoseCalState state = HOSECAL_IDLE;   // stepped in the control task
+static uint8_t  step = 0;
+static uint32_t startMs = 0, stepStartMs = 0;
+static double   A[3][3], b[3];  // normal equations on x = [Q, Q|Q|, dQ/dt]
+static uint16_t nPts = 0;
+static float    qMin = 0.0f, qMax = 0.0f;
+
+static inline float dropFor(float q, float dq) {
+  return model.r1 * q + model.r2 * q * fabsf(q) + model.l * dq;
+}
+
+// ------------------------------------------------
+void hoseBegin() {
+  hosePrefs.begin("cal", true);
+  model.valid = hosePrefs.getBool("hoseOk", false);
+  if (model.valid) {
+    model.r1 = hosePrefs.getFloat("hoseR1", model.r1);
+    model.r2 = hosePrefs.getFloat("hoseR2", model.r2);
+    model.l  = hosePrefs.getFloat("hoseL", model.l);
+  }
+  hosePrefs.end();
+  Serial.printf("Hose: %s r1=%.4f r2=%.6f l=%.4f\n",
+                model.valid ? "calibrated" : "nominal", model.r1, model.r2, model.l);
+}
+
+static void saveModel() {
+  hosePrefs.begin("cal", false);
+  hosePrefs.putFloat("hoseR1", model.r1);
+  hosePrefs.putFloat("hoseR2", model.r2);
+  hosePrefs.putFloat("hoseL", model.l);
+  hosePrefs.putBool("hoseOk", model.valid);
+  hosePrefs.end();
+}
+
+const HoseModel& hoseGetModel() { return model; }
+
+void hoseResetCal() {
+  model = HoseModel{};
+  hosePrefs.begin("cal", false);
+  hosePrefs.remove("hoseR1");
+  hosePrefs.remove("hoseR2");
+  hosePrefs.remove("hoseL");
+  hosePrefs.remove("hoseOk");
+  hosePrefs.end();
+}
+
+// ------------------------------------------------
+void hoseTrack(const PressureSample* s, uint8_t n, float ambient) {
+  for (uint8_t i = 0; i < n; ++i) {
+    if (!isfinite(s[i].pMask_hPa) || !isfinite(s[i].pBlower_hPa)) continue;
+    const float q = flowFromDiff_Lpm(s[i].pBlower_hPa - s[i].pMask_hPa);
+
+    if (!haveQ || s[i].t_us - lastQUs > 200000) {
+      qf = q; dqf = 0.0f;
+      lastQUs = s[i].t_us;
+      haveQ = true;
+      continue;
+    }
+    const float dt = max(1e-3f, (int32_t)(s[i].t_us - lastQUs) * 1e-6f);
+    lastQUs = s[i].t_us;
+    const float prev = qf;
+    qf  += 0.35f * (q - qf);                  // ~30 ms at 75 Hz
+    dqf += 0.25f * ((qf - prev) / dt - dqf);
+
+    // identification: hose end open, so the outlet gauge is the whole drop
+    if (state == HOSECAL_RUNNING && millis() - startMs >= HOSECAL_SETTLE_MS && isfinite(ambient)) {
+      const float x[3] = { qf, qf * fabsf(qf), dqf };
+      const float y = s[i].pMask_hPa - ambient;
+      for (uint8_t r = 0; r < 3; ++r) {
+        for (uint8_t c = 0; c < 3; ++c) A[r][c] += (double)x[r] * x[c];
+        b[r] += (double)x[r] * y;
+      }
+      if (nPts < 0xFFFF) nPts++;
+      qMin = min(qMin, qf);
+      qMax = max(qMax, qf);
+    }
+  }
+}
+
+float hoseFlow_Lpm() { return haveQ ? qf : NAN; }
+
+float hoseDrop_hPa() {
+  if (!haveQ || micros() - lastQUs > 200000) return 0.0f;  // no full pair lately
+  return dropFor(qf, dqf);
+}
+
+float hosePatientGauge_hPa(float outlet) {
+  return outlet - hoseDrop_hPa();
+}
+
+// ------------------------------------------------
+// Gaussian elimination with partial pivoting on the first k unknowns
+static bool solve(uint8_t k, double out[3]) {
+  double m[3][4];
+  for (uint8_t r = 0; r < k; ++r) {
+    for (uint8_t c = 0; c < k; ++c) m[r][c] = A[r][c];
+    m[r][k] = b[r];
+  }
+  for (uint8_t c = 0; c < k; ++c) {
+    uint8_t p = c;
+    for (uint8_t r = c + 1; r < k; ++r)
+      if (fabs(m[r][c]) > fabs(m[p][c])) p = r;
+    if (fabs(m[p][c]) < 1e-9 * (fabs(A[c][c]) + 1e-12)) return false;
+    if (p != c)
+      for (uint8_t j = 0; j <= k; ++j) { const double t = m[c][j]; m[c][j] = m[p][j]; m[p][j] = t; }
+    for (uint8_t r = c + 1; r < k; ++r) {
+      const double f = m[r][c] / m[c][c];
+      for (uint8_t j = c; j <= k; ++j) m[r][j] -= f * m[c][j];
+    }
+  }
+  for (int8_t r = k - 1; r >= 0; --r) {
+    double v = m[r][k];
+    for (uint8_t j = r + 1; j < k; ++j) v -= m[r][j] * out[j];
+    out[r] = v / m[r][r];
+  }
+  return true;
+}
+
+static bool fitAndSave() {
+  if (nPts < 200 || qMax - qMin < 30.0f) {
+    Serial.printf("Hose: too little flow excitation (%u pts, %.0f..%.0f L/min)\n", nPts, qMin, qMax);
+    return false;
+  }
+  double c[3] = { 0, 0, 0 };
+  bool ok = solve(3, c) && c[2] >= 0.0;
+  if (!ok) {  // inertance not resolved, resistive terms only
+    c[2] = 0.0;
+    ok = solve(2, c);
+  }
+  if (!ok || !isfinite(c[0]) || !isfinite(c[1]) || c[1] < 0.0) return false;
+
+  // the drop must be positive and plausible over the calibrated range
+  const float r1 = (float)c[0], r2 = (float)c[1];
+  const float qHi = max(fabsf(qMin), fabsf(qMax));
+  if (r1 + 2.0f * r2 * qHi < 0.0f || r1 * 60.0f + r2 * 3600.0f > 5.0f) return false;
+
+  model.r1 = r1;
+  model.r2 = r2;
+  model.l  = (float)c[2];
+  model.valid = true;
+  saveModel();
+  Serial.printf("Hose: fit r1=%.4f r2=%.6f l=%.4f (%u pts), %.2f hPa at 60 L/min\n",
+                model.r1, model.r2, model.l, nPts, dropFor(60.0f, 0.0f));
+  return true;
+}
+
+// ------------------------------------------------
+void hoseCalStart() {
+  for (uint8_t r = 0; r < 3; ++r) {
+    b[r] = 0.0;
+    for (uint8_t c = 0; c < 3; ++c) A[r][c] = 0.0;
+  }
+  nPts = 0;
+  qMin = qMax = 0.0f;
+  step = 0;
+  startMs = stepStartMs = millis();
+  state = HOSECAL_RUNNING;
+  Serial.println("Hose: identification started, mask must be off");
+}
+
+void hoseCalAbort() {
+  if (!hoseCalActive()) return;
+  state = HOSECAL_IDLE;
+  Serial.println("Hose: identification aborted");
+}
+
+bool hoseCalActive() { return state == HOSECAL_RUNNING; }
+HoseCalState hoseCalState() { return state; }
+
+float hoseCalSetpointCm() { return HOSECAL_CM[step]; }
+
+void hoseCalService() {
+  if (!hoseCalActive() || millis() - stepStartMs < HOSECAL_STEP_MS) return;
+  if (++step < HOSECAL_STEPS) {
+    stepStartMs = millis();
+    return;
+  }
+  step = HOSECAL_STEPS - 1;
+  state = HOSECAL_FITTING;
+}
+
+// as flowCalFinish(): the solve, NVS write and report stay out of the control task
+void hoseCalFinish() {
+  if (state != HOSECAL_FITTING) return;
+  const bool ok = fitAndSave();
+  if (!ok) Serial.println("Hose: fit rejected, keeping previous model");
+  state = ok ? HOSECAL_DONE : HOSECAL_FAILED;
+}
@@ -0,0 +1,53 @@
+// hose.h – hose resistance/inertance, device outlet → patient end
+#ifndef HOSE_H
+#define HOSE_H
+
+#include <Arduino.h>
+#include "sensor.h"  // PressureSample
+
+// Model: ΔP_hose[hPa] = r1·Q + r2·Q·|Q| + l·dQ/dt
+//        Q in L/min (+ve = toward patient), dQ/dt in L/min per s.
+// Patient pressure = outlet pressure − ΔP_hose, so it sags on inspiration
+// and rises above the outlet on expiration.
+struct HoseModel {
+  float r1 = 0.0f;     // laminar, hPa per L/min
+  float r2 = 1.4e-4f;  // turbulent, hPa per (L/min)², ~0.5 cm at 60 L/min on a 22 mm × 1.8 m hose
+  float l  = 0.0f;     // inertance, hPa per L/min/s
+  bool  valid = false; // false → nominal coefficients above
+};
+
+constexpr float HOSE_MAX_COMP_CM = 3.0f;  // cap on the set‑point feed‑forward
+
+// Identification run: hose end open to room (mask off), so the outlet gauge
+// pressure is the whole hose drop. Up and down steps excite the inertance.
+constexpr uint8_t  HOSECAL_STEPS   = 6;
+constexpr float    HOSECAL_CM[HOSECAL_STEPS] = { 4.0f, 8.0f, 12.0f, 16.0f, 10.0f, 4.0f };
+constexpr uint32_t HOSECAL_STEP_MS = 4000;
+constexpr uint32_t HOSECAL_SETTLE_MS = 1500;  // blower spin‑up before the first step counts
+
+enum HoseCalState : uint8_t {
+  HOSECAL_IDLE = 0,
+  HOSECAL_RUNNING,   // stepping the blower, collecting samples
+  HOSECAL_FITTING,   // steps done, fit and save pending in hoseCalFinish()
+  HOSECAL_DONE,      // last fit succeeded and was saved
+  HOSECAL_FAILED     // fit rejected, previous coefficients kept
+};
+
+void  hoseBegin();                    // load coefficients from NVS
+void  hoseTrack(const PressureSample* s, uint8_t n, float ambient_hPa);  // per acquisition
+float hoseFlow_Lpm();                 // per‑sample flow, lightly smoothed
+float hoseDrop_hPa();                 // current outlet → patient drop, 0 when unknown
+float hosePatientGauge_hPa(float outletGauge_hPa);
+const HoseModel& hoseGetModel();
+void  hoseResetCal();                 // back to nominal, erases NVS
+
+// Guided identification (driven from papLoop while active)
+void  hoseCalStart();
+void  hoseCalAbort();
+bool  hoseCalActive();
+void  hoseCalService();               // advances steps, hands the fit to hoseCalFinish()
+void  hoseCalFinish();                // fit, NVS save and report, from the UI loop
+float hoseCalSetpointCm();
+HoseCalState hoseCalState();
+
+#endif  // HOSE_H
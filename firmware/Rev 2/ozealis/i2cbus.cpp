@@ -0,0 +1,255 @@
+// i2cbus.cpp – implementation
+#include "i2cbus.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// known devices, the last slot collects anything else
+static I2cDevStats devs[] = {
+  { 0x5D }, { 0x5C },   // LPS22 mask, blower
+  { 0x38 },             // AHT20 inlet
+  { 0x44 }, { 0x45 },   // humidifier, heated hose
+  { 0x00 }              // other
+};
+static constexpr uint8_t DEV_COUNT = sizeof(devs) / sizeof(devs[0]);
+
+static SemaphoreHandle_t busMutex = nullptr;
+static uint32_t pressurePeriodUs = 50000;
+static uint32_t lastPressureUs = 0;
+static uint32_t deferred[I2C_PRIO_COUNT] = {};
+static I2cPrio  held = I2C_PRIO_PRESSURE;   // class of the current claim
+
+// recovery bookkeeping
+static uint8_t  busErrStreak = 0;
+static bool     recoverPending = false;
+static bool     recovering = false;
+static uint16_t recoveries = 0;
+static bool   (*recoverHook)() = nullptr;
+static bool     reinitPending = false;   // hook failed, again at the next pressure claim
+
+// Arduino-ESP32 returns: 0 ok, 1 tooLong, 2 NACK addr, 3 NACK data, 4 other (incl. timeout)
+static int8_t wireErr(uint8_t rc) {
+  switch (rc) {
+    case 0: return 0;
+    case 1: return -1;
+    case 2: return -2;
+    case 3: return -3;
+    default: return -4;
+  }
+}
+
+static I2cDevStats& devFor(uint8_t addr) {
+  for (uint8_t i = 0; i < DEV_COUNT - 1; ++i)
+    if (devs[i].addr == addr) return devs[i];
+  return devs[DEV_COUNT - 1];
+}
+
+// Wire timeout per class: pressure keeps the full one, lower classes their budget
+static uint16_t timeoutMs(I2cPrio prio) {
+  return prio == I2C_PRIO_PRESSURE ? IIC_TIMEOUT_MS : (uint16_t)max<uint32_t>(1, I2C_BUDGET_US[prio] / 1000);
+}
+
+// refused transactions are counted, not timed, and say nothing about the bus
+static bool admit(uint8_t addr) {
+  if (i2cBudgetLeft()) return true;
+  devFor(addr).errs[-I2C_ERR_BUDGET - 1]++;
+  return false;
+}
+
+static void account(uint8_t addr, int8_t rc, uint32_t us) {
+  I2cDevStats& d = devFor(addr);
+  d.txns++;
+  uint8_t b = 0;
+  for (uint32_t edge = 32; b < I2C_LAT_BUCKETS - 1 && us >= edge; edge <<= 1) b++;
+  d.lat[b]++;
+  if (us > d.maxUs) d.maxUs = us;
+  if (rc < 0 && -rc <= I2C_ERR_KINDS) d.errs[-rc - 1]++;
+
+  // a NACK is the device's problem; bus-level errors or a held SDA are ours
+  if (recovering) return;
+  if (rc == -4 || rc == -5) {
+    if (busErrStreak < 0xFF) busErrStreak++;
+  } else if (rc == 0) {
+    busErrStreak = 0;
+  }
+  if (busErrStreak >= 3 || (rc != 0 && digitalRead(IIC_SDA) == LOW)) recoverPending = true;
+}
+
+// ------------------------------------------------
+void i2cBusBegin() {
+  Wire.begin(IIC_SDA, IIC_SCL);
+  Wire.setClock(IIC_CLOCK_HZ);
+  Wire.setTimeOut(IIC_TIMEOUT_MS);
+  if (!busMutex) busMutex = xSemaphoreCreateMutex();
+}
+
+void i2cSetPressurePeriod(uint32_t us) { pressurePeriodUs = us; }
+void i2cOnRecover(bool (*hook)()) { recoverHook = hook; }
+
+// The hook restarts the pressure sensors, so it runs as pressure whoever
+// held the bus when recovery was triggered: a lower class's budget must not
+// refuse half of a sensor's configuration and leave it powered down.
+static void runRecoverHook() {
+  if (!recoverHook) return;
+  const I2cPrio was = held;
+  held = I2C_PRIO_PRESSURE;
+  Wire.setTimeOut(timeoutMs(held));
+  const bool ok = recoverHook();
+  if (!ok && !reinitPending) Serial.println("[I2C] Device re-init failed, retrying");
+  reinitPending = !ok;
+  held = was;
+  Wire.setTimeOut(timeoutMs(held));
+}
+
+bool i2cClaim(I2cPrio prio) {
+  if (!busMutex) return true;  // before i2cBusBegin(), setup is single threaded
+  if (prio == I2C_PRIO_PRESSURE) {
+    if (xSemaphoreTake(busMutex, pdMS_TO_TICKS(IIC_TIMEOUT_MS)) != pdTRUE) {
+      deferred[prio]++;
+      return false;
+    }
+    lastPressureUs = micros();
+    held = prio;
+    Wire.setTimeOut(timeoutMs(prio));
+    if (reinitPending) runRecoverHook();
+    return true;
+  }
+  // lower classes must fit before the next pressure slot
+  const uint32_t sincePressure = micros() - lastPressureUs;
+  if (sincePressure + I2C_BUDGET_US[prio] > pressurePeriodUs ||
+      xSemaphoreTake(busMutex, 0) != pdTRUE) {
+    deferred[prio]++;
+    return false;
+  }
+  held = prio;
+  Wire.setTimeOut(timeoutMs(prio));
+  return true;
+}
+
+bool i2cBudgetLeft() {
+  if (held == I2C_PRIO_PRESSURE || !busMutex) return true;
+  return micros() - lastPressureUs + timeoutMs(held) * 1000UL <= pressurePeriodUs;
+}
+
+void i2cRelease() {
+  if (recoverPending) i2cRecover();
+  if (busMutex) xSemaphoreGive(busMutex);
+}
+
+// ------------------------------------------------
+int8_t i2cWrite(uint8_t addr, const uint8_t* d, uint8_t n) {
+  if (!admit(addr)) return I2C_ERR_BUDGET;
+  const uint32_t t0 = micros();
+  Wire.beginTransmission(addr);
+  if (n) Wire.write(d, n);
+  const int8_t rc = wireErr(Wire.endTransmission(true));
+  account(addr, rc, micros() - t0);
+  return rc;
+}
+
+int8_t i2cWriteReg(uint8_t addr, uint8_t reg, uint8_t val) {
+  const uint8_t b[2] = { reg, val };
+  return i2cWrite(addr, b, 2);
+}
+
+int8_t i2cRead(uint8_t addr, uint8_t* buf, uint8_t n) {
+  if (!admit(addr)) return I2C_ERR_BUDGET;
+  const uint32_t t0 = micros();
+  int8_t rc = 0;
+  if (Wire.requestFrom(addr, n) != n) rc = -5;
+  else for (uint8_t i = 0; i < n; ++i) buf[i] = (uint8_t)Wire.read();
+  account(addr, rc, micros() - t0);
+  return rc;
+}
+
+int8_t i2cReadReg(uint8_t addr, uint8_t reg, uint8_t* buf, uint8_t n) {
+  if (!admit(addr)) return I2C_ERR_BUDGET;
+  const uint32_t t0 = micros();
+  Wire.beginTransmission(addr);
+  Wire.write(reg);
+  int8_t rc = wireErr(Wire.endTransmission(false));
+  if (rc == 0) {
+    if (Wire.requestFrom(addr, n) != n) rc = -5;
+    else for (uint8_t i = 0; i < n; ++i) buf[i] = (uint8_t)Wire.read();
+  }
+  account(addr, rc, micros() - t0);
+  return rc;
+}
+
+// ------------------------------------------------
+// clock out a slave stuck mid-byte, then issue a STOP and restart Wire
+bool i2cRecover() {
+  recovering = true;
+  recoverPending = false;
+  Wire.end();
+
+  pinMode(IIC_SDA, INPUT_PULLUP);
+  pinMode(IIC_SCL, OUTPUT_OPEN_DRAIN);
+  digitalWrite(IIC_SCL, HIGH);
+  delayMicroseconds(5);
+  for (uint8_t i = 0; i < 9 && digitalRead(IIC_SDA) == LOW; ++i) {
+    digitalWrite(IIC_SCL, LOW);
+    delayMicroseconds(5);
+    digitalWrite(IIC_SCL, HIGH);
+    delayMicroseconds(5);
+  }
+  // STOP: SDA low → high while SCL high
+  pinMode(IIC_SDA, OUTPUT_OPEN_DRAIN);
+  digitalWrite(IIC_SDA, LOW);
+  delayMicroseconds(5);
+  digitalWrite(IIC_SDA, HIGH);
+  delayMicroseconds(5);
+  const bool freed = digitalRead(IIC_SDA) == HIGH;
+
+  Wire.begin(IIC_SDA, IIC_SCL);
+  Wire.setClock(IIC_CLOCK_HZ);
+  Wire.setTimeOut(IIC_TIMEOUT_MS);
+  if (recoveries < 0xFFFF) recoveries++;
+  busErrStreak = 0;
+  Serial.println(freed ? "[I2C] Bus recovered" : "[I2C] Bus recovery failed, SDA still low");
+
+  runRecoverHook();
+  recovering = false;
+  return freed;
+}
+
+uint16_t i2cRecoveries() { return recoveries; }
+uint32_t i2cDeferred(I2cPrio prio) { return prio < I2C_PRIO_COUNT ? deferred[prio] : 0; }
+
+String i2cStatsCsv() {
+  String out;
+  out.reserve(768);
+  out += "addr,txns,tooLong,nackAddr,nackData,bus,short,budget,maxUs";
+  for (uint8_t b = 0; b < I2C_LAT_BUCKETS; ++b) {
+    char h[12];
+    snprintf(h, sizeof(h), ",lt%lu", 32UL << b);
+    out += h;
+  }
+  out += "\n";
+  for (uint8_t i = 0; i < DEV_COUNT; ++i) {
+    const I2cDevStats& d = devs[i];
+    char line[160];
+    int n = snprintf(line, sizeof(line), "0x%02X,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu",
+                     d.addr, (unsigned long)d.txns,
+                     (unsigned long)d.errs[0], (unsigned long)d.errs[1], (unsigned long)d.errs[2],
+                     (unsigned long)d.errs[3], (unsigned long)d.errs[4], (unsigned long)d.errs[5],
+                     (unsigned long)d.maxUs);
+    for (uint8_t b = 0; b < I2C_LAT_BUCKETS && n < (int)sizeof(line); ++b)
+      n += snprintf(line + n, sizeof(line) - n, ",%lu", (unsigned long)d.lat[b]);
+    out += line;
+    out += "\n";
+  }
+  char tail[96];
+  snprintf(tail, sizeof(tail), "recoveries,%u,deferred,%lu,%lu,%lu\n", recoveries,
+           (unsigned long)deferred[0], (unsigned long)deferred[1], (unsigned long)deferred[2]);
+  out += tail;
+  return out;
+}
+
+void i2cStatsReset() {
+  for (uint8_t i = 0; i < DEV_COUNT; ++i) {
+    const uint8_t a = devs[i].addr;
+    devs[i] = I2cDevStats{};
+    devs[i].addr = a;
+  }
+  for (uint8_t p = 0; p < I2C_PRIO_COUNT; ++p) deferred[p] = 0;
+}
@@ -0,0 +1,65 @@
+// i2cbus.h – shared Wire bus: priority slots, per-device accounting, recovery
+#ifndef I2CBUS_H
+#define I2CBUS_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// I2C pins
+#define IIC_SDA 21
+#define IIC_SCL 22
+
+// I2C fast mode for FIFO burst drains
+#define IIC_CLOCK_HZ 400000
+#define IIC_TIMEOUT_MS 10   // a clean 125 byte burst takes ~3.5 ms
+
+// Priority classes. Pressure always gets the bus; the others only get a
+// claim if it cannot run into the next pressure slot.
+enum I2cPrio : uint8_t {
+  I2C_PRIO_PRESSURE = 0,   // LPS22 pair, safety path
+  I2C_PRIO_AMBIENT,        // inlet AHT20
+  I2C_PRIO_ACCESSORY,      // hot-plug modules
+  I2C_PRIO_COUNT
+};
+
+// worst-case bus time each lower class may take before the next pressure slot
+// (the control task runs pressure every 4‑10 ms, so these must fit well inside that).
+// It holds per transaction, not only at the claim: a lower class runs with the
+// Wire timeout cut to its budget, and each accounted transaction is refused
+// (-6, nothing sent) once a timeout could run into the next pressure slot.
+constexpr uint32_t I2C_BUDGET_US[I2C_PRIO_COUNT] = { 0, 1500, 3000 };
+
+constexpr uint8_t I2C_LAT_BUCKETS = 12;  // log2 buckets from 32 µs up to ~65 ms
+constexpr uint8_t I2C_ERR_KINDS   = 6;   // -1 too long, -2 NACK addr, -3 NACK data, -4 bus/timeout, -5 short read,
+                                         // -6 over budget
+constexpr int8_t  I2C_ERR_BUDGET  = -6;
+
+struct I2cDevStats {
+  uint8_t  addr;
+  uint32_t txns;
+  uint32_t errs[I2C_ERR_KINDS];
+  uint32_t lat[I2C_LAT_BUCKETS];
+  uint32_t maxUs;
+};
+
+void i2cBusBegin();                       // Wire.begin + clock + timeout + mutex
+bool i2cClaim(I2cPrio prio);              // false → not now, retry next loop
+void i2cRelease();                        // runs any pending bus recovery
+bool i2cBudgetLeft();                     // room for one more transaction in this claim
+void i2cSetPressurePeriod(uint32_t us);   // expected gap between pressure slots
+void i2cOnRecover(bool (*hook)());        // re-init devices after a bus reset, as pressure;
+                                          // false → again at the next pressure claim
+
+// Accounted transactions, 0 ok or a negative code as above. Call while claimed.
+int8_t i2cWrite(uint8_t addr, const uint8_t* d, uint8_t n);
+int8_t i2cWriteReg(uint8_t addr, uint8_t reg, uint8_t val);
+int8_t i2cRead(uint8_t addr, uint8_t* buf, uint8_t n);
+int8_t i2cReadReg(uint8_t addr, uint8_t reg, uint8_t* buf, uint8_t n);
+
+bool   i2cRecover();                      // SCL pulsing + STOP + Wire re-init
+uint16_t i2cRecoveries();
+uint32_t i2cDeferred(I2cPrio prio);       // claims refused per class
+String i2cStatsCsv();                     // per-device histogram dump
+void   i2cStatsReset();
+
+#endif  // I2CBUS_H
@@ -0,0 +1,64 @@
+// leak.cpp – implementation
+#include "leak.h"
+#include <math.h>
+
+static bool     kSet = false;
+static bool     fromBreaths = false;  // kSlow has had at least one whole breath
+static float    kSlow = LEAK_VENT_K;
+static float    kFast = LEAK_VENT_K;
+static float    sqrtP = 0.0f;         // at the last sample
+static bool     maskOff = false;
+static uint32_t flipSinceMs = 0;      // condition for the other state holding since
+
+// ------------------------------------------------
+void leakReset() {
+  kSet = fromBreaths = false;
+  kSlow = kFast = LEAK_VENT_K;
+  maskOff = false;
+  flipSinceMs = 0;
+}
+
+float leakSample(float q, float pm_cm, float dt) {
+  sqrtP = sqrtf(max(LEAK_P_FLOOR_CM, pm_cm));
+  const float k = q / sqrtP;
+  if (!kSet) {
+    kSlow = kFast = k;
+    kSet = true;
+  }
+  kFast += min(1.0f, dt / 2.0f) * (k - kFast);
+
+  // mask off: conductance far beyond any vent, held for a breath or two
+  const uint32_t now = millis();
+  const bool flip = maskOff ? kFast < LEAK_MASKON_RATIO * LEAK_VENT_K
+                            : kFast > LEAK_MASKOFF_RATIO * LEAK_VENT_K;
+  if (!flip) {
+    flipSinceMs = 0;
+  } else {
+    if (!flipSinceMs) flipSinceMs = now;
+    if (now - flipSinceMs >= (maskOff ? LEAK_MASKON_MS : LEAK_MASKOFF_MS)) {
+      maskOff = !maskOff;
+      flipSinceMs = 0;
+      if (!maskOff) {
+        kSlow = kFast;          // don't carry the open‑hose K back
+        fromBreaths = false;
+      }
+    }
+  }
+
+  // with the mask off follow the fast estimate, before the first breath a ~10 s mean
+  if (maskOff) kSlow = kFast;
+  else if (!fromBreaths) kSlow += min(1.0f, dt / 10.0f) * (k - kSlow);
+  return kSlow * sqrtP;
+}
+
+void leakBreath(double qInt, double sqrtPInt) {
+  if (sqrtPInt <= 0.0 || maskOff) return;
+  const float k = max(0.0f, (float)(qInt / sqrtPInt));
+  kSlow = fromBreaths ? kSlow + 0.3f * (k - kSlow) : k;
+  fromBreaths = true;
+}
+
+float leakK()                 { return kSlow; }
+float leakTotal_Lpm()         { return kSlow * sqrtP; }
+float leakUnintentional_Lpm() { return max(0.0f, kSlow - LEAK_VENT_K) * sqrtP; }
+bool  leakMaskOff()           { return maskOff; }
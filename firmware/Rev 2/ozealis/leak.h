@@ -0,0 +1,31 @@
+// leak.h – leak conductance from pressure/flow, mask‑off detection
+#ifndef LEAK_H
+#define LEAK_H
+
+#include <Arduino.h>
+
+/*  Every leak path (mask vent + unintentional) behaves as an orifice,
+    Q_leak = K·√P with P the mask gauge pressure, so one conductance K
+    describes the leak at any point of the pressure waveform (EPR, BiPAP).
+      K slow  per breath: ∫q dt / ∫√P dt, since a whole breath nets zero volume
+      K fast  ~2 s EMA of q/√P, breathing and all, for mask‑off only
+    Unintentional leak = (K − LEAK_VENT_K)·√P, the vent being the design
+    vent flow of a typical mask.                                             */
+
+constexpr float    LEAK_VENT_K        = 7.9f;   // L/min per √cmH₂O, ~25 L/min at 10 cm
+constexpr float    LEAK_P_FLOOR_CM    = 0.3f;   // √P floor, hose nearly open at standby
+constexpr float    LEAK_MASKOFF_RATIO = 4.0f;   // K fast / vent K to call the mask off
+constexpr float    LEAK_MASKON_RATIO  = 2.0f;   // and back on
+constexpr uint32_t LEAK_MASKOFF_MS    = 3000;   // ~a breath or two
+constexpr uint32_t LEAK_MASKON_MS     = 2000;
+constexpr float    LEAK_STANDBY_CM    = 2.0f;   // blower target while the mask is off
+
+void  leakReset();
+float leakSample(float q_Lpm, float pm_cm, float dt_s);  // per sample, returns leak flow now
+void  leakBreath(double qInt, double sqrtPInt);         // per breath, ∫q dt and ∫√P dt
+float leakK();                 // slow conductance
+float leakTotal_Lpm();         // at the current pressure
+float leakUnintentional_Lpm(); // total minus the vent, ≥ 0
+bool  leakMaskOff();
+
+#endif  // LEAK_H
@@ -1,5 +1,7 @@
 #include "led.h"
 #include <NeoPixelBus.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
 
 /* ------- user‑configurable ------- */
 #define NUM_LEDS 2
@@ -12,18 +14,55 @@ NeoPixelBus<NeoGrbFeature, NeoEsp32Rmt0Ws2812xMethod> led(NUM_LEDS, LED_SIG);
 static bool pairingActive = false;
 static float wavePhase = 0.0f;  // 0–1, advances each frame
 
+static esp_timer_handle_t applyTimer = nullptr;
+static portMUX_TYPE ledMux = portMUX_INITIALIZER_UNLOCKED;
+static RgbColor base[NUM_LEDS];      // mode colour / pairing wave, already scaled
+static RgbColor over(0, 0, 0);
+static bool     overOn = false;
+
+static RgbColor scaled(uint8_t r, uint8_t g, uint8_t b) {
+  return RgbColor((uint8_t)(r * brightness), (uint8_t)(g * brightness), (uint8_t)(b * brightness));
+}
+
+// the only place that touches the strip
+static void applyLED(void*) {
+  RgbColor px[NUM_LEDS];
+  portENTER_CRITICAL(&ledMux);
+  for (int i = 0; i < NUM_LEDS; ++i) px[i] = overOn ? over : base[i];
+  portEXIT_CRITICAL(&ledMux);
+  for (int i = 0; i < NUM_LEDS; ++i) led.SetPixelColor(i, px[i]);
+  led.Show();
+}
+
+static void kick() {
+  if (!applyTimer) return;
+  esp_timer_stop(applyTimer);        // a pending apply picks the newest colours anyway
+  esp_timer_start_once(applyTimer, 0);
+}
+
 //-------------------------------------
 void setupLED() {
   led.Begin();
   led.Show();  // all off
+  const esp_timer_create_args_t args = { applyLED, nullptr, ESP_TIMER_TASK, "led", false };
+  esp_timer_create(&args, &applyTimer);
 }
 
 void setLED(uint8_t r, uint8_t g, uint8_t b) {
-  RgbColor c((uint8_t)(r * brightness),
-             (uint8_t)(g * brightness),
-             (uint8_t)(b * brightness));
-  for (int i = 0; i < NUM_LEDS; ++i) led.SetPixelColor(i, c);
-  led.Show();
+  const RgbColor c = scaled(r, g, b);
+  portENTER_CRITICAL(&ledMux);
+  for (int i = 0; i < NUM_LEDS; ++i) base[i] = c;
+  portEXIT_CRITICAL(&ledMux);
+  kick();
+}
+
+void ledOverlay(bool on, uint32_t rgb) {
+  const RgbColor c = scaled((rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF);
+  portENTER_CRITICAL(&ledMux);
+  overOn = on;
+  over = c;
+  portEXIT_CRITICAL(&ledMux);
+  kick();
 }
 
 void ledTogglePairingWave(bool on) {
@@ -40,10 +79,10 @@ void ledPairingWaveService() {
   if (wavePhase >= 1.0f) wavePhase -= 1.0f;
   float a = wavePhase < 0.5f ? (wavePhase * 2.0f) : (2.0f - wavePhase * 2.0f);
   float b = 1.0f - a;
-  const uint8_t base = 255;
-  RgbColor c0(0, 0, base * a * brightness);
-  RgbColor c1(0, 0, base * b * brightness);
-  led.SetPixelColor(0, c0);
-  led.SetPixelColor(1, c1);
-  led.Show();
-}
\ No newline at end of file
+  const uint8_t level = 255;
+  portENTER_CRITICAL(&ledMux);
+  base[0] = RgbColor(0, 0, level * a * brightness);
+  base[1] = RgbColor(0, 0, level * b * brightness);
+  portEXIT_CRITICAL(&ledMux);
+  kick();
+}
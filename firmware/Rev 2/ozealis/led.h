@@ -12,8 +12,11 @@
 // NeoPixelBus LED declaration
 extern NeoPixelBus<NeoGrbFeature, NeoEsp32Rmt0Ws2812xMethod> led;
 
+// All writers only post colours; Show() runs in one place, an esp_timer
+// callback, so the control task (faults) and the UI never race the RMT.
 void setupLED();
 void setLED(uint8_t r, uint8_t g, uint8_t b);
+void ledOverlay(bool on, uint32_t rgb);  // sequencer pattern over the mode colour
 void ledTogglePairingWave(bool on);   // start/stop wave animation
 void ledPairingWaveService();                    // must be called every loop()
 
@@ -26,7 +26,6 @@ enum FaultType : uint8_t {
   FAULT_IO
 };
 
-static uint32_t lastTick = 0;
 
 // ───── Limits & constants ───────────────────────────────────
 constexpr uint32_t BLE_TIMEOUT_MS = 30'000;     // 30 s
@@ -38,8 +37,10 @@ extern FaultType currentFault;
 
 // ───── API ─────────────────────────────────────────────────
 void runMainLogic();             // call every 50 ms in loop()
-void enterMode(SystemMode m);    // state machine jump
-void triggerFault(FaultType f);  // raises fault & enters MODE_FAULT
+void runBleStream();             // call every 1 s in loop()
+void enterMode(SystemMode m);    // state machine jump, applied by the control task
+void triggerFault(FaultType f);  // raises fault & enters MODE_FAULT (control task)
+void clearFault();               // the only way out of MODE_FAULT from the UI, to IDLE
 
 #endif  // LOGIC_H
 
@@ -48,8 +49,19 @@ void triggerFault(FaultType f);  // raises fault & enters MODE_FAULT
 #include "autopap.h"  // therapy & motor control lives here
 #include "motor.h"    // restartMotor(), setMotorAmplitude()
 #include "buzzer.h"
+#include "sequencer.h"
 #include "led.h"
 #include "button.h"
+#include "autozero.h"
+#include "estimator.h"
+#include "datalog.h"
+#include "apnea.h"
+#include "control.h"
+#include "i2cbus.h"  // i2cSetPressurePeriod()
+#include "span.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_task_wdt.h>
 #include <BLEDevice.h>
 
 // -------- External symbols provided by BLE unit ------------
@@ -69,14 +81,24 @@ SystemMode currentMode = MODE_IDLE;
 FaultType currentFault = FAULT_NONE;
 FaultType lastFault = FAULT_NONE;
 
-// -------- Local helpers ------------------------------------
-static void alarmBeep(uint8_t n) {
-  for (uint8_t i = 0; i < n; ++i) {
-    buzz(80);
-    delay(120);
-  }
-}
+// -------- Control task state -------------------------------
+static TaskHandle_t ctlTask = nullptr;
+static volatile uint16_t ctlHzReq = CONTROL_HZ_DEFAULT;
+static ControlStats ctlStats{};
+static float ctlMask_hPa = NAN;         // newest mask sample, for the BLE stream
+static volatile uint16_t faultSeq = 0;  // bumped per trip, annunciated by the UI
+
+// -------- Mode requests ------------------------------------
+// Only the control task changes the mode: it trips faults, and a loop-side
+// jump racing a trip could re-enable the drive under MODE_FAULT. The button,
+// BLE and the UI loop post a request it applies at the top of its next
+// period. MODE_FAULT is sticky, requests are dropped until clearFault().
+static portMUX_TYPE modeMux = portMUX_INITIALIZER_UNLOCKED;
+static int8_t modeReq = -1;             // SystemMode, -1 none
+static bool   clearReq = false;
+static void applyMode(SystemMode m);
 
+// -------- Local helpers ------------------------------------
 const char* modeName(SystemMode m){
   switch(m){
     case MODE_IDLE: return "IDLE";
@@ -107,7 +129,7 @@ void triggerFault(FaultType f) {
 
   // Build snapshot
   float pMask = NAN, pBlower = NAN;
-  readPressures(pMask, pBlower); // use cached fallback if needed
+  sensorGetLatest(pMask, pBlower); // newest drained pair, NAN for a failed sensor
   const float diff = (isnan(pMask) || isnan(pBlower)) ? NAN : (pBlower - pMask);
   FaultSnapshot snap{};
   snap.ts_ms        = millis();
@@ -121,23 +143,49 @@ void triggerFault(FaultType f) {
   snap.setpoint_cm  = papGetSetpointCm();
   snap.flowProxy_hPa= papGetFlowProxy();
   snap.motorAmp     = motorGetAmplitude();
+  snap.estMask_hPa  = estMaskGauge_hPa();
+  snap.estConf      = estConfidence();
   sensorDiagGet(snap.miss1, snap.miss2, snap.i2cErr1, snap.i2cErr2);
   diag_capture_fault(snap);  // log it
 
+  // blower off first; message, BLE event and beeps follow from the UI loop
   currentFault = f;
-  sendBLEEvent("FAULT");
-
-  switch (f) {
-    case FAULT_LOW_VIN: alarmBeep(2); break;
-    case FAULT_SENSOR: alarmBeep(3); break;
-    case FAULT_OVERPRESSURE: alarmBeep(5); break;
-    default: alarmBeep(1); break;
-  }
-  enterMode(MODE_FAULT);
+  applyMode(MODE_FAULT);
+  faultSeq++;
 }
 
 // -----------------------------------------------------------
 void enterMode(SystemMode m) {
+  portENTER_CRITICAL(&modeMux);
+  modeReq = (int8_t)m;
+  portEXIT_CRITICAL(&modeMux);
+}
+
+void clearFault() {
+  portENTER_CRITICAL(&modeMux);
+  clearReq = true;
+  modeReq = -1;
+  portEXIT_CRITICAL(&modeMux);
+}
+
+// control task only
+static void applyModeRequests() {
+  portENTER_CRITICAL(&modeMux);
+  const int8_t req = modeReq;
+  const bool clear = clearReq;
+  modeReq = -1;
+  clearReq = false;
+  portEXIT_CRITICAL(&modeMux);
+
+  if (clear && currentMode == MODE_FAULT) {
+    Serial.println("Fault cleared, entering idle");
+    currentFault = FAULT_NONE;
+    applyMode(MODE_IDLE);
+  }
+  if (req >= 0 && currentMode != MODE_FAULT) applyMode((SystemMode)req);
+}
+
+static void applyMode(SystemMode m) {
   // Allow STARTUP to transition to RUNNING even if we "think" we are already running
   if (m != MODE_STARTUP && currentMode == m) return;
 
@@ -150,6 +198,7 @@ void enterMode(SystemMode m) {
       break;
 
     case MODE_STARTUP:
+      apneaReset();                  // AHI is per therapy session
       // Transitional alias: request motor start and immediately treat as RUNNING
       setLED(255, 255, 0);           // yellow for "starting"
       motorSetDriveEnabled(true);    // schedules non-blocking startMotor()
@@ -162,10 +211,10 @@ void enterMode(SystemMode m) {
       break;
 
     case MODE_SHUTDOWN:
-      setLED(255, 150, 0);           // orange
       motorSetDriveEnabled(false);
-      delay(500);                    // ok, this is UI-level, not in motor code
-      enterMode(MODE_IDLE);
+      sleepEndSession();             // the night ends with the stop, not 15 min later
+      applyMode(MODE_IDLE);
+      seqPlay(SEQ_SHUTDOWN);         // orange flash over the idle colour, no wait
       break;
 
     case MODE_FAULT:
@@ -176,23 +225,47 @@ void enterMode(SystemMode m) {
 }
 
 // -----------------------------------------------------------
-void runMainLogic() {
+// completed breath and event records into the datalog ring (datalog.h)
+static void logRecords() {
+  static uint32_t breathsLogged = 0, eventsLogged = 0;
+
+  const uint32_t bSeq = breathSeq();
+  if (bSeq - breathsLogged > BREATH_RING) breathsLogged = bSeq - BREATH_RING;
+  BreathRecord r;
+  for (; breathsLogged < bSeq; ++breathsLogged) {
+    if (breathGet(breathsLogged, r)) dl_pushBreath(millis(), r);
+  }
+
+  const uint32_t eSeq = apneaSeq();
+  if (eventsLogged > eSeq) eventsLogged = 0;  // new session
+  if (eSeq - eventsLogged > APNEA_RING) eventsLogged = eSeq - APNEA_RING;
+  ApneaEvent e;
+  for (; eventsLogged < eSeq; ++eventsLogged) {
+    if (apneaGet(eventsLogged, e)) dl_pushEvent(e);
+  }
+}
+
+// -----------------------------------------------------------
+// Control task: acquisition, safety and papLoop at a fixed rate.
+// Anything slow or UI-facing is left to runMainLogic() in loop().
+
+static void controlStep() {
+  applyModeRequests();
+
   /* 0. VIN MONITOR -------------------------------------------------- */
+  uint32_t c0 = spanStart();
   float vin = vinFiltered();
   if (currentMode != MODE_FAULT) {
     if (vin < VIN_TRIP_V) {
       if (!vinLowSince) vinLowSince = millis();
-      if (millis() - vinLowSince > VIN_TRIP_MS){
-        triggerFault(FAULT_LOW_VIN);
-        Serial.println("VIN fault detected");
-      }
+      if (millis() - vinLowSince > VIN_TRIP_MS) triggerFault(FAULT_LOW_VIN);
     } else {
       vinLowSince = 0;
     }
   } else if (currentFault == FAULT_LOW_VIN && vin > VIN_RECOVER_V) {
     Serial.println("Low VIN Fault has recovered, entering idle");
     currentFault = FAULT_NONE;              // clear latched fault
-    enterMode(MODE_IDLE);
+    applyMode(MODE_IDLE);
   }  
 
   // If we're "running" but not spinning, kick a start
@@ -211,67 +284,264 @@ void runMainLogic() {
     }
   }
 
+  spanEnd(SPAN_VIN, c0);
+
   /* 1. SENSOR HEALTH ------------------------------------------------ */
-  if (!sensorsOK()) {
-    Serial.println("Sensor fault detected");
+  c0 = spanStart();
+  const SensorHealth health = sensorHealth();
+  if (health == SENSE_NONE) {
     triggerFault(FAULT_SENSOR);
     return;
   }
 
+  // One side lost: keep therapy going on the estimator at a capped pressure
+  const bool degraded = health != SENSE_BOTH;
+  if (degraded != papIsDegraded()) papSetDegraded(degraded);
+  spanEnd(SPAN_HEALTH, c0);
+
   /* 2. PRESSURE ACQUISITION ---------------------------------------- */
+  c0 = spanStart();
   float pMask, pBlower;
-  readPressures(pMask, pBlower);
+  const bool bothOK = readPressures(pMask, pBlower);
   float diff_hPa = pBlower - pMask;
+  ctlMask_hPa = pMask;
+
+  // Fuse every aligned pair into the mask pressure estimate
+  const PressureSample* batch;
+  const uint8_t batchN = sensorGetBatch(batch);
+  estUpdate(batch, batchN, sensorAmbient_hPa());
+  hoseTrack(batch, batchN, sensorAmbient_hPa());
+  breathTrack(batch, batchN, sensorAmbient_hPa());
+  apneaService(currentMode == MODE_RUNNING && !degraded && motorGetAmplitude() > 0 &&
+               !flowCalActive() && !hoseCalActive() && !leakMaskOff());
 
   // Choose a gauge limit, for example 25 cmH2O safety ceiling
   constexpr float MAX_MASK_CM = 25.0f;
+  constexpr float MAX_MASK_DEGRADED_CM = PAP_DEGRADED_MAX_CM + 5.0f;
 
+  // Estimate when it is trustworthy, otherwise the fresh raw sample (NAN if none).
+  // Degraded: judge the upper edge of the estimate's error bound instead.
   float maskGauge_hPa = NAN;
-  if (isfinite(sensorAmbient_hPa())) {
+  if (degraded && estValid()) {
+    maskGauge_hPa = estMaskGauge_hPa() + estMaskErrBound_hPa();
+  } else if (estValid() && estConfidence() >= 0.5f) {
+    maskGauge_hPa = estMaskGauge_hPa();
+  } else if (isfinite(sensorAmbient_hPa())) {
     maskGauge_hPa = pMask - sensorAmbient_hPa();
   }
 
   // Update ambient estimate using this loop's readings
   sensorUpdateAmbientEstimate(pMask, diff_hPa);
 
-  // Trip only if we have a valid gauge estimate
+  // Blower stopped means true flow is zero, let auto-zero learn the offset
+  azSetZeroFlow(motorGetAmplitude() == 0 && !motorIsStarting());
+
+  // Trip only if we have a valid gauge estimate. On expiration the patient end
+  // sits above the outlet by the hose drop, judge whichever is higher.
   if (isfinite(maskGauge_hPa)) {
-    if (maskGauge_hPa > cmH2O_to_hPa(MAX_MASK_CM)) {
+    const float worst_hPa = max(maskGauge_hPa, hosePatientGauge_hPa(maskGauge_hPa));
+    if (worst_hPa > cmH2O_to_hPa(degraded ? MAX_MASK_DEGRADED_CM : MAX_MASK_CM)) {
       triggerFault(FAULT_OVERPRESSURE);
       return;
     }
+  } else if (degraded && currentMode == MODE_RUNNING && (motorGetAmplitude() > 0 || motorIsStarting())) {
+    // Degraded with nothing to judge: the mask side was lost before the
+    // estimator ever came up, so there is no estimate and no ambient either.
+    // The blower must not run with the trip silent.
+    triggerFault(FAULT_SENSOR);
+    return;
   }
 
+  spanEnd(SPAN_ACQ, c0);
+
   /* 3. DELEGATE TO AutoPAP (handles motor) */
+  c0 = spanStart();
   if (currentMode == MODE_RUNNING) {
     motorTrapKeepalive(1200, 200);   // ~833 Hz electrical, healthy capture
-    papLoop();                       // sine writes are suppressed while trap is active
+    papLoop(pMask, pBlower, bothOK); // sine writes are suppressed while trap is active
   } else {
-    motorSetDriveEnabled(false);
+    static uint32_t lastOff = 0;     // keep the old 20 Hz re-assert, not every period
+    if (millis() - lastOff >= 50) {
+      motorSetDriveEnabled(false);
+      lastOff = millis();
+    }
+  }
+  spanEnd(SPAN_PAP, c0);
+}
+
+static void controlTask(void*) {
+  uint16_t hz = 0;
+  TickType_t period = 1, wake = 0;
+  uint32_t ideal_us = 0, period_us = 0;
+
+  ESP_ERROR_CHECK(esp_task_wdt_add(nullptr));   // a stuck control loop resets, as loop() does
+  for (;;) {
+    // (re)arm on a rate change, whole ticks only
+    if (hz != ctlHzReq) {
+      hz = ctlHzReq;
+      period = max<TickType_t>(1, configTICK_RATE_HZ / hz);
+      period_us = (uint32_t)period * (1000000UL / configTICK_RATE_HZ);
+      ctlStats.hz = (uint16_t)(configTICK_RATE_HZ / period);
+      i2cSetPressurePeriod(period_us);
+      wake = xTaskGetTickCount();
+      ideal_us = micros();
+    }
+
+    const uint32_t t0 = micros();
+    const int32_t late = (int32_t)(t0 - ideal_us);
+    const uint32_t c0 = spanStart();
+    controlStep();
+    spanEnd(SPAN_CTL, c0);
+    const uint32_t exec = micros() - t0;
+
+    ctlStats.periods++;
+    if (late > 0) {
+      if ((uint32_t)late > ctlStats.maxLate_us) ctlStats.maxLate_us = late;
+      ctlStats.avgLate_us += 0.01f * (late - ctlStats.avgLate_us);
+    }
+    if (exec > ctlStats.maxExec_us) ctlStats.maxExec_us = exec;
+    if (exec > period_us) ctlStats.overruns++;
+    if (ctlStats.periods > 1) diag_note_loop_us((uint16_t)min<uint32_t>(65000, period_us + max<int32_t>(0, late)));
+
+    ideal_us += period_us;
+    if ((int32_t)(micros() - ideal_us) > (int32_t)period_us) {
+      // fell a whole period behind (motor start, flash write), don't burst to catch up
+      wake = xTaskGetTickCount();
+      ideal_us = micros() + period_us;
+    }
+    esp_task_wdt_reset();
+    vTaskDelayUntil(&wake, period);
+  }
+}
+
+void controlBegin(uint16_t hz) {
+  controlSetRate(hz);
+  if (!ctlTask)
+    xTaskCreatePinnedToCore(controlTask, "pap_ctl", 6144, nullptr, CONTROL_TASK_PRIO, &ctlTask, 1);
+}
+
+void controlSetRate(uint16_t hz) {
+  ctlHzReq = constrain(hz, CONTROL_HZ_MIN, CONTROL_HZ_MAX);
+}
+
+const ControlStats& controlGetStats() { return ctlStats; }
+
+void controlStatsReset() {
+  ctlStats.maxLate_us = 0;
+  ctlStats.maxExec_us = 0;
+}
+
+// -----------------------------------------------------------
+// UI side, from loop(): annunciation, slow services, BLE and logging
+void runMainLogic() {
+  const uint32_t c0 = spanStart();
+
+  // faults are tripped in the control task, sounded here
+  static uint16_t faultsAnnounced = 0;
+  if (faultsAnnounced != faultSeq) {
+    faultsAnnounced = faultSeq;
+    const FaultType f = lastFault;
+    switch (f) {
+      case FAULT_LOW_VIN:      Serial.println("VIN fault detected"); break;
+      case FAULT_SENSOR:       Serial.println("Sensor fault detected"); break;
+      case FAULT_OVERPRESSURE: Serial.println("Overpressure fault detected"); break;
+      default: break;
+    }
+    sendBLEEvent("FAULT");
+    switch (f) {
+      case FAULT_LOW_VIN: seqPlay(SEQ_FAULT_VIN); break;
+      case FAULT_SENSOR: seqPlay(SEQ_FAULT_SENSOR); break;
+      case FAULT_OVERPRESSURE: seqPlay(SEQ_FAULT_OVERP); break;
+      default: seqPlay(SEQ_FAULT_OTHER); break;
+    }
   }
 
-  /* 4. BASIC BLE STREAM (mask press & VIN) ------------------------- */
-  if (bleActive && char_liveCsv) {
-    static uint32_t lastBle = 0;
-    if (millis() - lastBle >= 1000) {
-      char buf[48];
-      snprintf(buf, sizeof(buf), "%.2f,%.2f", pMask, vin);
-      char_liveCsv->setValue(buf);
-      char_liveCsv->notify();
-      lastBle = millis();
+  // One side lost: the control task holds a capped pressure, tell the user
+  static bool wasDegraded = false;
+  if (papIsDegraded() != wasDegraded) {
+    const bool degraded = wasDegraded = papIsDegraded();
+    Serial.println(degraded ? (sensorHealth() == SENSE_MASK_ONLY ? "Degraded: blower sensor lost"
+                                                                 : "Degraded: mask sensor lost")
+                            : "Degraded mode cleared, both sensors back");
+    sendBLEEvent(degraded ? "DEGRADED" : "RESTORED");
+    if (degraded) seqPlay(SEQ_NOTICE_BEEP);
+    if (currentMode == MODE_RUNNING) {
+      if (degraded) setLED(255, 60, 0);  // amber
+      else          setLED(0, 255, 0);
     }
   }
 
-  /* 5. BLE ADVERTISING TIMEOUT ------------------------------------ */
+  // Inlet temp/RH shares the bus, one short transaction at most per loop
+  ahtService();
+  azService();
+  flowCalFinish();   // calibration fits and NVS saves, collected in the control task
+  hoseCalFinish();
+  logRecords();
+
+  // Fan unloaded for its amplitude → blocked hose or airway, report only
+  static bool wasObstructed = false;
+  if (estAirwayObstructed() != wasObstructed) {
+    wasObstructed = estAirwayObstructed();
+    Serial.printf("Airway %s (load ratio %.2f)\n", wasObstructed ? "obstructed" : "clear", estLoadRatio());
+    if (wasObstructed) sendBLEEvent("OBSTRUCT");
+  }
+
+  // Mask off: the control task has already dropped to standby
+  static bool wasMaskOff = false;
+  if (leakMaskOff() != wasMaskOff) {
+    wasMaskOff = leakMaskOff();
+    Serial.printf("Mask %s (leak %.0f L/min)\n", wasMaskOff ? "off, blower to standby" : "back on", leakTotal_Lpm());
+    sendBLEEvent(wasMaskOff ? "MASKOFF" : "MASKON");
+    if (wasMaskOff) seqPlay(SEQ_NOTICE_BEEP);
+  }
+
+  // Sleep/wake from breathing regularity, usage hours, auto-ramp onset
+  const bool therapy = currentMode == MODE_RUNNING && papBlowerOn() && !papIsDegraded() && !leakMaskOff() &&
+                       !flowCalActive() && !hoseCalActive();
+  static uint32_t seenAutoStops = 0;
+  if (papAutoStops() != seenAutoStops) {
+    seenAutoStops = papAutoStops();
+    sleepEndSession();
+  }
+  sleepService(therapy);
+  if (nightService(therapy && papGetMode() == MODE_CPAP && papAutoTitrate())) papSeedFromNights();
+  static bool wasAsleep = false;
+  if (sleepAsleep() != wasAsleep) {
+    wasAsleep = sleepAsleep();
+    Serial.printf("Sleep: %s (CV period %.2f, Vt %.2f)\n", wasAsleep ? "onset" : "awake", sleepCvPeriod(), sleepCvVt());
+    sendBLEEvent(wasAsleep ? "SLEEP" : "WAKE");
+  }
+
+  // Waxing/waning ventilation (Cheyne-Stokes pattern), report only
+  static bool wasPeriodic = false;
+  if (asvPeriodicBreathing() != wasPeriodic) {
+    wasPeriodic = asvPeriodicBreathing();
+    Serial.printf("Periodic breathing %s (cycle %.0f s)\n", wasPeriodic ? "detected" : "ended", asvCycle_s());
+    if (wasPeriodic) sendBLEEvent("PERIODIC");
+  }
+
+  /* 4. BLE ADVERTISING TIMEOUT ------------------------------------ */
   if (bleActive && millis() - bleStartTime > BLE_TIMEOUT_MS) {
     BLEDevice::getAdvertising()->stop();
     bleActive = false;
     ledTogglePairingWave(false);   // stop animation
     enterMode(MODE_IDLE);
   }
+  spanEnd(SPAN_UI, c0);
+}
 
-  uint32_t now_us = micros();
-  uint32_t dt_us = lastTick ? (now_us - lastTick) : 0;
-  lastTick = now_us;
-  if (dt_us && dt_us < 65000) diag_note_loop_us((uint16_t)dt_us);  // cap at 65 ms
+// BASIC BLE STREAM (mask press, VIN, flow & inlet), its own 1 s job
+void runBleStream() {
+  if (!bleActive || !char_liveCsv) return;
+  const uint32_t c0 = spanStart();
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.2f,%.2f,%.1f,%.1f,%.1f", ctlMask_hPa, vinFiltered(), papGetFlowLpm(),
+           sensorInletTemp_C(), sensorInletRH());
+  char_liveCsv->setValue(buf);
+  char_liveCsv->notify();
+  if (char_ahi) {
+    char_ahi->setValue(String(apneaAHI(), 1).c_str());
+    char_ahi->notify();
+  }
+  spanEnd(SPAN_BLE, c0);
 }
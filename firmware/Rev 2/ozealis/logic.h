@@ -37,8 +37,10 @@ extern FaultType currentFault;
 
 // ───── API ─────────────────────────────────────────────────
 void runMainLogic();             // call every 50 ms in loop()
-void enterMode(SystemMode m);    // state machine jump
-void triggerFault(FaultType f);  // raises fault & enters MODE_FAULT
+void runBleStream();             // call every 1 s in loop()
+void enterMode(SystemMode m);    // state machine jump, applied by the control task
+void triggerFault(FaultType f);  // raises fault & enters MODE_FAULT (control task)
+void clearFault();               // the only way out of MODE_FAULT from the UI, to IDLE
 
 const char* modeName(SystemMode m);
 const char* faultName(FaultType f);
@@ -1,18 +1,15 @@
 // modules.cpp – implementation
 #include "modules.h"
+#include "i2cbus.h"
 
 ModuleStatus humid, hose;
-static unsigned long lastScan = 0;
 static uint8_t heartbeatFrame = 0;
 
 // accessory protocol: register 0x00 returns 0xA5 when alive
 static bool heartbeat(uint8_t addr) {
-  Wire.beginTransmission(addr);
-  Wire.write(0x00);
-  if (Wire.endTransmission(false) != 0) return false;
-  Wire.requestFrom(addr, (uint8_t)1);
-  if (!Wire.available()) return false;
-  return Wire.read() == 0xA5;
+  uint8_t b = 0;
+  if (i2cReadReg(addr, 0x00, &b, 1) != 0) return false;
+  return b == 0xA5;
 }
 
 static void powerRail(bool on) {
@@ -30,9 +27,8 @@ void pollModules(float targetRH, float targetTubeT) {
   static bool wasHumidPresent = false;
   static bool wasHosePresent = false;
 
-  // run every 500 ms
-  if (millis() - lastScan < 500) return;
-  lastScan = millis();
+  // scheduled every 500 ms (sched.h), in the accessory slot after pressure acquisition
+  if (!i2cClaim(I2C_PRIO_ACCESSORY)) return;  // retry next period
 
   // Step‑1: ensure rail is on while scanning
   powerRail(true);
@@ -45,22 +41,18 @@ void pollModules(float targetRH, float targetTubeT) {
     humid.ready = true;
 
     // read temp/RH from registers 0x01‑0x04 (example)
-    Wire.beginTransmission(ADDR_HUMIDIFIER);
-    Wire.write(0x01);
-    if (Wire.endTransmission(false) == 0 && Wire.requestFrom(ADDR_HUMIDIFIER, (uint8_t)4) == 4) {
-      uint16_t tRaw = (Wire.read() << 8) | Wire.read();
-      uint16_t hRaw = (Wire.read() << 8) | Wire.read();
+    uint8_t r[4];
+    if (i2cReadReg(ADDR_HUMIDIFIER, 0x01, r, 4) == 0) {
+      uint16_t tRaw = (r[0] << 8) | r[1];
+      uint16_t hRaw = (r[2] << 8) | r[3];
       humid.temp_C = tRaw / 100.0f;
       humid.rh_percent = hRaw / 100.0f;
     }
 
     // send target RH (%)
     uint16_t rh = targetRH * 100;
-    Wire.beginTransmission(ADDR_HUMIDIFIER);
-    Wire.write(0x10);  // target register
-    Wire.write((rh >> 8) & 0xFF);
-    Wire.write(rh & 0xFF);
-    Wire.endTransmission();
+    const uint8_t w[3] = { 0x10, (uint8_t)((rh >> 8) & 0xFF), (uint8_t)(rh & 0xFF) };  // target register
+    i2cWrite(ADDR_HUMIDIFIER, w, 3);
   } else {
     if (wasHumidPresent) Serial.println("[I2C] Humidifier disconnected.");
     humid = {};
@@ -68,28 +60,27 @@ void pollModules(float targetRH, float targetTubeT) {
   wasHumidPresent = humidNow;
 
   // ---- Heated Hose ----
+  if (!i2cBudgetLeft()) { i2cRelease(); return; }   // next pressure slot too close, keep its state
   bool hoseNow = heartbeat(ADDR_HEATEDHOSE);
   if (hoseNow) {
     if (!wasHosePresent) Serial.println("[I2C] Heated hose detected.");
     hose.present = true;
     hose.ready = true;
 
-    Wire.beginTransmission(ADDR_HEATEDHOSE);
-    Wire.write(0x01);
-    if (Wire.endTransmission(false) == 0 && Wire.requestFrom(ADDR_HEATEDHOSE, (uint8_t)2) == 2) {
-      uint16_t tRaw = (Wire.read() << 8) | Wire.read();
+    uint8_t r[2];
+    if (i2cReadReg(ADDR_HEATEDHOSE, 0x01, r, 2) == 0) {
+      uint16_t tRaw = (r[0] << 8) | r[1];
       hose.temp_C = tRaw / 100.0f;
     }
 
-    Wire.beginTransmission(ADDR_HEATEDHOSE);
-    Wire.write(0x10);
-    Wire.write((uint8_t)targetTubeT);  // °C delta
-    Wire.endTransmission();
+    const uint8_t w[2] = { 0x10, (uint8_t)targetTubeT };  // °C delta
+    i2cWrite(ADDR_HEATEDHOSE, w, 2);
   } else {
     if (wasHosePresent) Serial.println("[I2C] Heated hose disconnected.");
     hose = {};
   }
   wasHosePresent = hoseNow;
+  i2cRelease();
 
   // Cut rail if no response for 2 s
   static uint8_t missCnt = 0;
@@ -23,7 +23,7 @@ struct ModuleStatus {
 extern ModuleStatus humid, hose;
 
 void initModules();                 // call once in setup()
-void pollModules(float targetRH,    // call from loop(): desired RH (%)
+void pollModules(float targetRH,    // call every 500 ms from loop(): desired RH (%)
                  float targetTubeT  // desired hose °C above ambient
 );
 
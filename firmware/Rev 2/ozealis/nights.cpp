@@ -0,0 +1,234 @@
+// nights.cpp – implementation
+#include "nights.h"
+#include "sleep.h"    // sleepSessionStartMs(), sleepUsage()
+#include "titrate.h"  // titrPressure_cm()
+#include "apnea.h"    // apneaSeq(), apneaGet()
+#include <Preferences.h>
+
+static Preferences nightPrefs;   // NVS namespace "nights"
+
+struct NightModel {
+  float    p50, p95;
+  uint16_t nights;
+  float    hours[NIGHT_BINS];
+  float    events[NIGHT_BINS];
+};
+static NightModel model{};
+static NightSummary ring[NIGHT_KEEP];
+static uint8_t head = 0, count = 0;
+
+// current session, the part that is checkpointed
+struct NightCur {
+  uint32_t hist[NIGHT_BINS];     // seconds per EPAP bin
+  uint16_t evt[NIGHT_BINS];      // obstructive events per bin
+  uint32_t seconds;
+  uint16_t nObs, nCen, nHyp;
+};
+static NightCur cur{};
+static uint32_t sessMs = 0;
+static uint32_t lastSecMs = 0, lastSaveMs = 0;
+static bool     dirty = false;   // cur changed since the checkpoint
+static uint32_t seenEvent = 0;
+
+static uint8_t binOf(float cm) {
+  return (uint8_t)constrain(lroundf((cm - NIGHT_BIN0_CM) / NIGHT_BIN_CM), 0L, (long)NIGHT_BINS - 1);
+}
+static float cmOf(uint8_t b) { return NIGHT_BIN0_CM + b * NIGHT_BIN_CM; }
+
+static float percentile(float f) {
+  const uint32_t want = (uint32_t)ceilf(f * cur.seconds);
+  uint32_t cum = 0;
+  for (uint8_t b = 0; b < NIGHT_BINS; ++b) {
+    cum += cur.hist[b];
+    if (cum >= want) return cmOf(b);
+  }
+  return cmOf(NIGHT_BINS - 1);
+}
+
+static void clearSession() {
+  cur = NightCur{};
+  dirty = false;
+  seenEvent = apneaSeq();
+}
+
+static void checkpoint() {
+  nightPrefs.begin("nights", false);
+  nightPrefs.putBytes("cur", &cur, sizeof(cur));
+  nightPrefs.end();
+  dirty = false;
+  lastSaveMs = millis();
+}
+
+static void dropCheckpoint() {
+  nightPrefs.begin("nights", false);
+  nightPrefs.remove("cur");
+  nightPrefs.end();
+}
+
+static void save() {
+  nightPrefs.begin("nights", false);
+  nightPrefs.putBytes("ring", ring, sizeof(ring));
+  nightPrefs.putUChar("head", head);
+  nightPrefs.putUChar("count", count);
+  nightPrefs.putBytes("model", &model, sizeof(model));
+  nightPrefs.end();
+}
+
+// a finished session becomes a summary and one model update
+static bool closeNight() {
+  const uint16_t minutes = (uint16_t)min<uint32_t>(0xFFFF, cur.seconds / 60);
+  if (minutes < NIGHT_MIN_MIN) return false;
+
+  NightSummary& s = ring[head];
+  s = NightSummary{};
+  s.session     = (uint16_t)sleepUsage().sessions;
+  s.minutes     = minutes;
+  s.p50_x10     = (uint8_t)lroundf(percentile(0.50f) * 10.0f);
+  s.p90_x10     = (uint8_t)lroundf(percentile(0.90f) * 10.0f);
+  s.p95_x10     = (uint8_t)lroundf(percentile(0.95f) * 10.0f);
+  s.obstructive = (uint8_t)min<uint16_t>(255, cur.nObs);
+  s.central     = (uint8_t)min<uint16_t>(255, cur.nCen);
+  s.hypopnea    = (uint8_t)min<uint16_t>(255, cur.nHyp);
+  head = (head + 1) % NIGHT_KEEP;
+  if (count < NIGHT_KEEP) count++;
+
+  const float p50 = s.p50_x10 / 10.0f, p95 = s.p95_x10 / 10.0f;
+  model.p50 = model.nights ? model.p50 + NIGHT_EMA * (p50 - model.p50) : p50;
+  model.p95 = model.nights ? model.p95 + NIGHT_EMA * (p95 - model.p95) : p95;
+  for (uint8_t b = 0; b < NIGHT_BINS; ++b) {
+    model.hours[b]  = model.hours[b] * NIGHT_DECAY + cur.hist[b] / 3600.0f;
+    model.events[b] = model.events[b] * NIGHT_DECAY + cur.evt[b];
+  }
+  if (model.nights < 0xFFFF) model.nights++;
+  save();
+  Serial.printf("Nights: session %u stored, %.1f h, p50 %.1f p95 %.1f cm, OA %u CA %u H %u\n", s.session,
+                minutes / 60.0f, p50, p95, s.obstructive, s.central, s.hypopnea);
+  return true;
+}
+
+// ------------------------------------------------
+void nightBegin() {
+  nightPrefs.begin("nights", true);
+  if (nightPrefs.getBytesLength("model") == sizeof(model) &&
+      nightPrefs.getBytesLength("ring") == sizeof(ring)) {
+    nightPrefs.getBytes("model", &model, sizeof(model));
+    nightPrefs.getBytes("ring", ring, sizeof(ring));
+    head = nightPrefs.getUChar("head", 0) % NIGHT_KEEP;
+    count = min<uint8_t>(nightPrefs.getUChar("count", 0), NIGHT_KEEP);
+  }
+  const bool cut = nightPrefs.getBytesLength("cur") == sizeof(cur);
+  if (cut) nightPrefs.getBytes("cur", &cur, sizeof(cur));
+  nightPrefs.end();
+
+  // a session in progress when the power went: it ends here
+  if (cut) {
+    Serial.printf("Nights: session cut by a reset, %.1f h\n", cur.seconds / 3600.0f);
+    closeNight();
+    dropCheckpoint();
+  }
+  clearSession();
+}
+
+bool nightService(bool learning) {
+  const uint32_t now = millis();
+  bool stored = false;
+
+  const uint32_t s = sleepSessionStartMs();
+  if (s != sessMs) {
+    if (sessMs) {
+      stored = closeNight();
+      dropCheckpoint();
+    }
+    sessMs = s;
+    clearSession();
+    lastSecMs = lastSaveMs = now;
+  }
+  if (!sessMs) return stored;
+
+  if (learning && now - lastSecMs >= 1000) {
+    lastSecMs += 1000;
+    if (now - lastSecMs >= 1000) lastSecMs = now;
+    cur.hist[binOf(titrPressure_cm())]++;
+    cur.seconds++;
+    dirty = true;
+  } else if (!learning) {
+    lastSecMs = now;
+  }
+
+  const uint32_t eSeq = apneaSeq();
+  if (eSeq < seenEvent) seenEvent = 0;  // apnea counters restarted
+  ApneaEvent e;
+  for (; seenEvent < eSeq; ++seenEvent) {
+    if (!learning || !apneaGet(seenEvent, e)) continue;
+    dirty = true;
+    if (e.type == EVT_HYPOPNEA) cur.nHyp++;
+    else if (e.airway == AIRWAY_OPEN) { cur.nCen++; continue; }
+    else cur.nObs++;
+    cur.evt[binOf(titrPressure_cm())]++;
+  }
+
+  if (dirty && now - lastSaveMs >= NIGHT_SAVE_MS) checkpoint();
+  return stored;
+}
+
+NightProposal nightPropose(float pMin, float pMax) {
+  NightProposal p{};
+  p.nights = model.nights;
+  p.start_cm = p.floor_cm = pMin;
+  p.ceil_cm = pMax;
+  if (model.nights < NIGHT_MIN_NIGHTS) return p;
+
+  p.learned = true;
+  p.p50_cm = model.p50;
+  p.p95_cm = model.p95;
+
+  // lowest level whose residual event rate, at and above it, is acceptable
+  float hAbove = 0.0f, eAbove = 0.0f;
+  for (int8_t b = NIGHT_BINS - 1; b >= 0; --b) {
+    hAbove += model.hours[b];
+    eAbove += model.events[b];
+    if (hAbove < NIGHT_MIN_HOURS) continue;
+    if (eAbove / hAbove < NIGHT_RATE_OK) p.eff_cm = cmOf(b);
+    else if (p.eff_cm > 0.0f) break;   // events again below this, stop here
+  }
+
+  const float start = p.eff_cm > 0.0f ? constrain(p.eff_cm, model.p50 - 1.0f, max(model.p50, model.p95)) : model.p50;
+  p.start_cm = constrain(start, pMin, pMax);
+  p.floor_cm = max(pMin, p.start_cm - NIGHT_FLOOR_BELOW);
+  p.ceil_cm  = constrain(model.p95 + NIGHT_CEIL_ABOVE, p.start_cm, pMax);
+  return p;
+}
+
+void nightReport(float pMin, float pMax) {
+  const NightProposal p = nightPropose(pMin, pMax);
+  if (!p.learned) {
+    Serial.printf("Nights: %u learned, need %u, titrating from %.1f in %.1f-%.1f cm\n", p.nights,
+                  NIGHT_MIN_NIGHTS, p.start_cm, p.floor_cm, p.ceil_cm);
+  } else {
+    Serial.printf("Nights: %u learned, p50 %.1f p95 %.1f cm", p.nights, p.p50_cm, p.p95_cm);
+    if (p.eff_cm > 0.0f) Serial.printf(", <%.0f ev/h from %.1f cm", NIGHT_RATE_OK, p.eff_cm);
+    else Serial.print(", events too frequent to judge, from p50");
+    Serial.printf(" -> start %.1f, range %.1f-%.1f (user %.1f-%.1f)\n", p.start_cm, p.floor_cm, p.ceil_cm,
+                  pMin, pMax);
+  }
+  NightSummary s;
+  for (uint8_t i = 0; nightGet(i, s); ++i)
+    Serial.printf("  #%u %.1f h p50 %.1f p90 %.1f p95 %.1f OA %u CA %u H %u\n", s.session, s.minutes / 60.0f,
+                  s.p50_x10 / 10.0f, s.p90_x10 / 10.0f, s.p95_x10 / 10.0f, s.obstructive, s.central, s.hypopnea);
+}
+
+uint8_t nightCount() { return count; }
+
+bool nightGet(uint8_t back, NightSummary& out) {
+  if (back >= count) return false;
+  out = ring[(head + NIGHT_KEEP - 1 - back) % NIGHT_KEEP];
+  return true;
+}
+
+void nightReset() {
+  model = NightModel{};
+  head = count = 0;
+  nightPrefs.begin("nights", false);
+  nightPrefs.clear();
+  nightPrefs.end();
+}
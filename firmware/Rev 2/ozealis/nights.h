@@ -0,0 +1,65 @@
+// nights.h – per‑night titration summaries and the across‑night seed
+#ifndef NIGHTS_H
+#define NIGHTS_H
+
+#include <Arduino.h>
+
+/*  Each therapy session (sleep.h) under auto‑titrating CPAP keeps a 1 s
+    histogram of EPAP in 0.5 cm bins and the obstructive events (apnea.h,
+    centrals excluded) at the pressure they happened. At the end of the
+    session a compact NightSummary goes into a ring in NVS, and the model
+    is updated. The session in progress is checkpointed to NVS every
+    NIGHT_SAVE_MS; one found at boot was cut by a reset or power loss and
+    is closed there, so a night is never lost for want of a clean end.
+    The model:
+      p50, p95        EMA across nights of the night's percentiles
+      hours/events    per pressure bin, decayed by NIGHT_DECAY per night
+    After NIGHT_MIN_NIGHTS nights of at least NIGHT_MIN_MIN the model
+    proposes the next session:
+      start   lowest pressure with < NIGHT_RATE_OK events/h at or above it,
+              kept within p50 − 1 … p95 (p50 if too little data)
+      floor   start − NIGHT_FLOOR_BELOW
+      ceiling p95 + NIGHT_CEIL_ABOVE
+    all clamped to the user's pMin..pMax.                                 */
+
+constexpr float    NIGHT_BIN_CM      = 0.5f;
+constexpr float    NIGHT_BIN0_CM     = 4.0f;
+constexpr uint8_t  NIGHT_BINS        = 33;      // 4 … 20 cm
+constexpr uint8_t  NIGHT_KEEP        = 14;      // summaries in NVS
+constexpr uint16_t NIGHT_MIN_MIN     = 120;     // shorter sessions don't teach
+constexpr uint8_t  NIGHT_MIN_NIGHTS  = 3;
+constexpr float    NIGHT_EMA         = 0.3f;    // weight of the newest night
+constexpr float    NIGHT_DECAY       = 0.8f;
+constexpr float    NIGHT_RATE_OK     = 5.0f;    // events/h
+constexpr float    NIGHT_MIN_HOURS   = 1.0f;    // at or above a level to judge it
+constexpr float    NIGHT_FLOOR_BELOW = 2.0f;
+constexpr float    NIGHT_CEIL_ABOVE  = 3.0f;
+constexpr uint32_t NIGHT_SAVE_MS     = 300000;  // 5 min, ~250 B blob
+
+// 12 bytes per night
+struct NightSummary {
+  uint16_t session;      // sleep.h session counter
+  uint16_t minutes;      // therapy time
+  uint8_t  p50_x10, p90_x10, p95_x10;   // EPAP percentiles, cm × 10
+  uint8_t  obstructive;  // apneas, closed or unclassified airway
+  uint8_t  central;
+  uint8_t  hypopnea;
+  uint16_t reserved;
+};
+
+struct NightProposal {
+  bool  learned;     // false → user limits, start at pMin
+  float start_cm, floor_cm, ceil_cm;
+  float p50_cm, p95_cm, eff_cm;   // what it came from, eff 0 = not judged
+  uint16_t nights;
+};
+
+void  nightBegin();                 // loads ring and model, closes a night cut by a reset
+bool  nightService(bool learning);  // from loop(); learning = CPAP with auto‑titration; true = night stored
+NightProposal nightPropose(float pMin, float pMax);
+void  nightReport(float pMin, float pMax);   // summaries and proposal on Serial
+uint8_t nightCount();
+bool  nightGet(uint8_t back, NightSummary& out);   // 0 = newest
+void  nightReset();
+
+#endif  // NIGHTS_H
@@ -9,6 +9,7 @@
 #include "led.h"
 #include "button.h"
 #include "buzzer.h"
+#include "sequencer.h"
 #include "motor.h"
 #include "ble.h"
 #include "autopap.h"
@@ -17,60 +18,139 @@
 #include "logic.h"
 #include "modules.h"
 #include "datalog.h"
+#include "flowcal.h"
+#include "hose.h"
+#include "estimator.h"
+#include "snore.h"
+#include "cardio.h"
+#include "control.h"
+#include "sched.h"
 #include <esp32-hal-ledc.h>
 #include <esp_task_wdt.h>
 #include <WiFi.h>
 
+// -------- loop() jobs, run by sched.h --------------------------
+static void statusJob() {
+  float setpoint = papGetSetpointCm();
+  float flow = papGetFlowProxy();
+  float vin = vinFiltered();
+  Serial.print("State: mode=");
+  Serial.print(modeName(currentMode));
+  Serial.print(" fault=");
+  Serial.print(faultName(currentFault));
+  Serial.print(" last_fault=");
+  Serial.print(faultName(lastFault));
+  if (papIsDegraded()) {
+    Serial.print(" DEGRADED bound_hPa=");
+    Serial.print(estMaskErrBound_hPa(), 2);
+  }
+  Serial.print(" setpoint_cm=");
+  Serial.print(setpoint, 2);
+  Serial.print(" flow_proxy=");
+  Serial.print(flow, 2);
+  Serial.print(" flow_lpm=");
+  Serial.print(papGetFlowLpm(), 1);
+  Serial.print(" leak_lpm=");
+  Serial.print(leakUnintentional_Lpm(), 1);
+  if (leakMaskOff()) Serial.print(" MASK_OFF");
+  Serial.print(" rr=");
+  Serial.print(breathRate_bpm(), 1);
+  Serial.print(" vt_ml=");
+  Serial.print(breathVt_mL(), 0);
+  if (papGetMode() == MODE_CPAP && settings.autoPap) {
+    Serial.printf(" apap_cm=%.1f", titrPressure_cm());
+  }
+  if (papGetMode() == MODE_ASV) {
+    Serial.printf(" mv=%.1f/%.1f ps_cm=%.1f", asvRecentMV_Lpm(), asvTarget_Lpm(), asvPS_cm());
+  }
+  if (papGetMode() != MODE_CPAP) {
+    const TrigStats& ts = trigGetStats();
+    Serial.printf(" trig_ms=%u/%.0f/%u false=%lu backup=%lu", ts.lastLat_ms, ts.avgLat_ms, ts.maxLat_ms,
+                  (unsigned long)ts.falseTriggers, (unsigned long)ts.backupCycles);
+    trigStatsReset();
+  }
+  if (sleepSessionStartMs()) {
+    const SleepUsage& u = sleepUsage();
+    Serial.printf(" %s use_h=%.2f/%.2f", sleepAsleep() ? "ASLEEP" : "awake", u.sessionTherapy_s / 3600.0f,
+                  u.sessionSleep_s / 3600.0f);
+  }
+  const SnoreStats& ss = snoreGetStats();
+  Serial.printf(" snore_us=%.0f/%lu", ss.avg_us, (unsigned long)ss.max_us);
+  snoreStatsReset();
+  Serial.print(" vin=");
+  Serial.print(vin, 2);
+  Serial.print(" V inlet=");
+  Serial.print(sensorInletTemp_C(), 1);
+  Serial.print(" C ");
+  Serial.print(sensorInletRH(), 1);
+  Serial.print(" %RH");
+  const ControlStats& cs = controlGetStats();
+  Serial.printf(" loop=%.0f%%", schedLoadPct());
+  Serial.printf(" ctl=%uHz late_us=%.0f/%lu exec_us=%lu overruns=%lu\n", cs.hz, cs.avgLate_us,
+                (unsigned long)cs.maxLate_us, (unsigned long)cs.maxExec_us, (unsigned long)cs.overruns);
+  controlStatsReset();
+  motorDumpPins();
+}
+
+static void modulesJob() {
+  pollModules(settings.targetRH, settings.tubeDelta);
+}
+
+// rate monotonic: the shorter the period, the higher the priority
+static const SchedJob JOBS[] = {
+  // name       fn                     period ms  prio  budget us
+  { "button",  pollButton,            20,        0,    300 },
+  { "main",    runMainLogic,          50,        1,    5000 },
+  { "ledwave", ledPairingWaveService, 50,        2,    1500 },
+  { "mdbg",    motorDebugService,     50,        3,    2000 },
+  { "modules", modulesJob,            500,       4,    3000 },
+  { "ble",     runBleStream,          1000,      5,    3000 },
+  { "status",  statusJob,             2000,      6,    5000 },
+};
+
 void setup() {
   ESP_ERROR_CHECK(esp_task_wdt_add(nullptr));
   Serial.begin(115200);
   Serial.println("Ozealis - Booting");
   delay(200);
   loadSettings();
+  flowBegin();
+  hoseBegin();
   otaSecure_begin();
   setupLED();
   setupBuzzer();
+  seqBegin();
   setupButton();
   setupSensors();
+  estBegin();
+  breathBegin();
+  snoreBegin();
+  cardioBegin();
+  sleepBegin();
+  nightBegin();
   MotorProfile tune;
   setupMotor(tune);
   initModules();
   PapLimits limits = { 4.0f, 15.0f, 4.0f, 300, true, true, 3 };  // pMin, pMax, Δ, ramp, autoStart, autoStop, EPR
+  limits.pMin = settings.pMin;   // user limits, the learned seed stays inside them
+  limits.pMax = settings.pMax;
+  limits.learn = settings.learn;
+  limits.autoTitrate = settings.autoPap;
+  limits.autoRamp = settings.autoRamp;
   papBegin(limits);
+  nightReport(limits.pMin, limits.pMax);
   dl_init();
+  transConfigure(settings.riseMs, settings.fallMs, (TransShape)settings.riseShape);
+  trigConfigure(settings.trig);
+  controlBegin(settings.ctlHz);  // acquisition + safety + papLoop from here on
   pinMode(ACC_EN, OUTPUT);
   digitalWrite(ACC_EN, LOW);
   buzz(100);
   setLED(255, 0, 255);
+  schedBegin(JOBS, sizeof(JOBS) / sizeof(JOBS[0]));
 }
 
 void loop() {
   esp_task_wdt_reset();
-  runMainLogic();
-  pollButton();
-  ledPairingWaveService();
-  motorDebugService();
-  static uint32_t lastLog = 0;
-  uint32_t now = millis();
-  if (now - lastLog >= 2000) {
-    lastLog = now;
-    float setpoint = papGetSetpointCm();
-    float flow = papGetFlowProxy();
-    float vin = vinFiltered();
-    Serial.print("State: mode=");
-    Serial.print(modeName(currentMode));
-    Serial.print(" fault=");
-    Serial.print(faultName(currentFault));
-    Serial.print(" last_fault=");
-    Serial.print(faultName(lastFault));
-    Serial.print(" setpoint_cm=");
-    Serial.print(setpoint, 2);
-    Serial.print(" flow_proxy=");
-    Serial.print(flow, 2);
-    Serial.print(" vin=");
-    Serial.print(vin, 2);
-    Serial.println(" V");
-    motorDumpPins();
-  }
-  delay(50);
+  schedRun();  // due jobs, then sleeps to the next release
 }
@@ -0,0 +1,48 @@
+// pressctl.cpp – implementation
+#include "pressctl.h"
+#include <math.h>
+
+static bool  ffOn = true;
+static float ref = 0.0f;     // slewed target, cmH₂O
+static float integ = 0.0f;   // counts
+static float err = 0.0f;
+
+// ------------------------------------------------
+void pctlReset(float target_cm) {
+  ref = max(0.0f, target_cm);
+  integ = 0.0f;
+  err = 0.0f;
+}
+
+void pctlSetFeedForward(bool on) { ffOn = on; }
+
+uint8_t pctlFeedForward(float cm) {
+  return (uint8_t)constrain(cm * PCTL_FF_PER_CM, 0.0f, PCTL_OUT_MAX);
+}
+
+uint8_t pctlUpdate(float target, float meas, float dt) {
+  dt = constrain(dt, 0.0f, 0.2f);
+  const float step = PCTL_SLEW_CM_S * dt;
+  ref += constrain(max(0.0f, target) - ref, -step, step);
+
+  const float ff = ffOn ? ref * PCTL_FF_PER_CM : 0.0f;
+  if (!isfinite(meas)) {
+    err = 0.0f;
+    return (uint8_t)constrain(ff + integ, 0.0f, PCTL_OUT_MAX);
+  }
+
+  err = ref - meas;
+  const float u = ff + PCTL_KP * err + integ;
+
+  // integrate unless already saturated in the direction the error pushes
+  const bool railHi = u >= PCTL_OUT_MAX && err > 0.0f;
+  const bool railLo = u <= 0.0f && err < 0.0f;
+  if (!railHi && !railLo)
+    integ = constrain(integ + PCTL_KI * err * dt, -PCTL_I_MAX, PCTL_I_MAX);
+
+  return (uint8_t)constrain(ff + PCTL_KP * err + integ, 0.0f, PCTL_OUT_MAX);
+}
+
+float pctlTarget_cm() { return ref; }
+float pctlError_cm()  { return err; }
+float pctlIntegral()  { return integ; }
@@ -0,0 +1,29 @@
+// pressctl.h – closed‑loop patient pressure → blower amplitude
+#ifndef PRESSCTL_H
+#define PRESSCTL_H
+
+#include <Arduino.h>
+
+/*  u = ff(target) + Kp·e + I,  e = slewed target − measured (cmH₂O)
+    ff is the old open‑loop map (PCTL_FF_PER_CM · cm), so with no valid
+    measurement the blower behaves exactly as before. The integrator only
+    runs while the output is not pushed into a rail by it (conditional
+    integration) and is bounded on its own.                              */
+
+constexpr float PCTL_FF_PER_CM  = 16.0f;   // amplitude counts per cmH₂O, open loop
+constexpr float PCTL_KP         = 8.0f;    // counts per cmH₂O
+constexpr float PCTL_KI         = 30.0f;   // counts per cmH₂O·s
+constexpr float PCTL_I_MAX      = 80.0f;   // counts, integrator bound
+constexpr float PCTL_SLEW_CM_S  = 40.0f;   // target rate limit, rise and fall
+constexpr float PCTL_OUT_MAX    = 255.0f;
+
+void    pctlReset(float target_cm);    // blower start / after open‑loop use
+void    pctlSetFeedForward(bool on);   // default on
+uint8_t pctlFeedForward(float target_cm);  // open‑loop amplitude for a target
+// one control step; meas_cm NAN → feed‑forward only, integrator held
+uint8_t pctlUpdate(float target_cm, float meas_cm, float dt_s);
+float   pctlTarget_cm();               // slewed target actually tracked
+float   pctlError_cm();                // last e
+float   pctlIntegral();                // counts
+
+#endif  // PRESSCTL_H
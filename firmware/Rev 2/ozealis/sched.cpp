@@ -0,0 +1,89 @@
+// sched.cpp – implementation
+#include "sched.h"
+
+static const SchedJob* jobs = nullptr;
+static uint8_t    nJobs = 0;
+static uint32_t   due[SCHED_MAX_JOBS];
+static SchedStats stats[SCHED_MAX_JOBS];
+static uint32_t   idleUs = 0, windowUs = 0;
+
+static void runJob(uint8_t i, uint32_t now) {
+  const SchedJob& j = jobs[i];
+  SchedStats& s = stats[i];
+
+  const uint32_t t0 = micros();
+  j.fn();
+  const uint32_t exec = micros() - t0;
+
+  s.runs++;
+  s.avgExec_us = s.runs > 1 ? s.avgExec_us + 0.05f * (exec - s.avgExec_us) : exec;
+  if (exec > s.maxExec_us) s.maxExec_us = exec;
+  if (exec > j.budget_us) s.overruns++;
+  s.maxLate_ms = (uint16_t)max<uint32_t>(s.maxLate_ms, min<uint32_t>(0xFFFF, now - due[i]));
+
+  due[i] += j.period_ms;
+  if ((int32_t)(millis() - due[i]) >= 0) {
+    // a whole period behind, resync rather than run back to back
+    s.skips++;
+    due[i] = millis() + j.period_ms;
+  }
+}
+
+// ------------------------------------------------
+void schedBegin(const SchedJob* table, uint8_t n) {
+  jobs = table;
+  nJobs = min(n, SCHED_MAX_JOBS);
+  const uint32_t now = millis();
+  for (uint8_t i = 0; i < nJobs; ++i) due[i] = now;
+  schedStatsReset();
+}
+
+void schedRun() {
+  // due jobs, highest priority first, each at most once per pass
+  uint16_t ran = 0;
+  for (uint8_t pass = 0; pass < nJobs; ++pass) {
+    const uint32_t now = millis();
+    int8_t pick = -1;
+    for (uint8_t i = 0; i < nJobs; ++i) {
+      if (ran & (1u << i) || (int32_t)(now - due[i]) < 0) continue;
+      if (pick < 0 || jobs[i].prio < jobs[pick].prio) pick = i;
+    }
+    if (pick < 0) break;
+    ran |= 1u << pick;
+    runJob(pick, now);
+  }
+
+  // sleep to the next release, that is the idle time
+  const uint32_t now = millis();
+  int32_t wait = INT32_MAX;
+  for (uint8_t i = 0; i < nJobs; ++i) wait = min(wait, (int32_t)(due[i] - now));
+  if (wait > 0) {
+    const uint32_t t0 = micros();
+    delay(wait);
+    idleUs += micros() - t0;
+  }
+}
+
+float schedLoadPct() {
+  const uint32_t el = micros() - windowUs;
+  return el ? 100.0f * (1.0f - (float)idleUs / el) : 0.0f;
+}
+
+const SchedStats& schedGetStats(uint8_t i) { return stats[min<uint8_t>(i, SCHED_MAX_JOBS - 1)]; }
+
+void schedReport() {
+  Serial.printf("Sched: load %.1f%% over %.1f s\n", schedLoadPct(), (micros() - windowUs) * 1e-6f);
+  for (uint8_t i = 0; i < nJobs; ++i) {
+    const SchedJob& j = jobs[i];
+    const SchedStats& s = stats[i];
+    Serial.printf("  %-8s %5u ms p%u runs %lu exec %.0f/%lu us budget %u over %lu late %u ms skip %lu\n", j.name,
+                  j.period_ms, j.prio, (unsigned long)s.runs, s.avgExec_us, (unsigned long)s.maxExec_us,
+                  j.budget_us, (unsigned long)s.overruns, s.maxLate_ms, (unsigned long)s.skips);
+  }
+}
+
+void schedStatsReset() {
+  for (uint8_t i = 0; i < SCHED_MAX_JOBS; ++i) stats[i] = SchedStats{};
+  idleUs = 0;
+  windowUs = micros();
+}
@@ -0,0 +1,42 @@
+// sched.h – cooperative rate‑monotonic scheduler for the loop() jobs
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <Arduino.h>
+
+/*  loop() work is a static table of periodic jobs. Each pass runs the due
+    jobs highest priority first (lower number; assign by period, shortest
+    first, i.e. rate monotonic), at most one run per job per pass, then
+    sleeps until the earliest next release. Releases are drift free
+    (due += period); a job that falls a whole period behind skips instead
+    of bursting. Per job: runs, avg/max execution, budget overruns, worst
+    release lateness and skips. Time spent sleeping is idle, the rest is
+    the load of the loop task. Control runs in its own task (control.h).  */
+
+constexpr uint8_t SCHED_MAX_JOBS = 12;
+
+struct SchedJob {
+  const char* name;
+  void      (*fn)();
+  uint16_t    period_ms;
+  uint8_t     prio;        // 0 = highest
+  uint16_t    budget_us;   // runs longer than this count as overruns
+};
+
+struct SchedStats {
+  uint32_t runs;
+  uint32_t overruns;
+  uint32_t skips;          // releases dropped after falling behind
+  uint32_t maxExec_us;
+  float    avgExec_us;
+  uint16_t maxLate_ms;     // release → start
+};
+
+void  schedBegin(const SchedJob* table, uint8_t n);
+void  schedRun();                          // the body of loop()
+float schedLoadPct();                      // since schedStatsReset()
+const SchedStats& schedGetStats(uint8_t i);
+void  schedReport();                       // table and stats on Serial
+void  schedStatsReset();
+
+#endif  // SCHED_H
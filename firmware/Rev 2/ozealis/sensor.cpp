@@ -1,5 +1,6 @@
 // sensor.cpp
 #include "sensor.h"
+#include "autozero.h"
 #include <math.h>
 
 // ========= user-configurable flags =========
@@ -10,23 +11,31 @@ Adafruit_LPS22 lps1;  // 0x5D mask side
 Adafruit_LPS22 lps2;  // 0x5C blower side
 Adafruit_AHTX0 aht;
 
-// ========= VIN filter =========
-static float vinLP = 0.0f;
-static constexpr float VIN_ALPHA = 0.05f;  // about 300 ms at ~50 Hz
+// ========= VIN acquisition =========
+// The ADC DMA engine averages VIN_ADC_OVERSAMPLE conversions per frame and
+// returns eFuse calibrated millivolts; a small task advances the filter once
+// per frame, so its time constant no longer depends on who reads it.
+static volatile float vinFast = 0.0f;
+static volatile float vinLP = 0.0f;
+static constexpr float VIN_FRAME_HZ = (float)VIN_ADC_SAMPLE_HZ / VIN_ADC_OVERSAMPLE;
+static constexpr float VIN_TAU_S = 0.3f;
+static const float VIN_ALPHA = 1.0f - expf(-1.0f / (VIN_FRAME_HZ * VIN_TAU_S));
+static TaskHandle_t vinTask = nullptr;
+static bool vinDma = false;    // false → fixed-rate analogReadMilliVolts fallback
 
 // ========= pressure read state =========
+static bool     lps1Found = false, lps2Found = false;   // answered at boot
 static bool     lps1OK = false;
 static bool     lps2OK = false;
-static uint32_t lastGoodMs = 0;
+static uint32_t lastGoodMs = 0;                   // both sides good
+static uint32_t lastGood1Ms = 0, lastGood2Ms = 0;  // per side, for degraded mode
 
 // cached absolute pressures for graceful fallback
 static float pMask_cache   = NAN;
 static float pBlower_cache = NAN;
 
-// transient failure debounce
-static uint16_t badReadStreak = 0;
-static constexpr uint16_t SENSOR_FAIL_DEBOUNCE = 5;   // ~250 ms at 50 ms loop
-static constexpr uint32_t STALE_MS = 500;             // consider stale after this
+// transient failure debounce, in time so it does not follow the control rate
+static constexpr uint32_t SENSOR_FAIL_DEBOUNCE_MS = 250;   // since the last good sample
 
 // ambient estimator for gauge pressure
 static float ambient_hPa = NAN;
@@ -39,15 +48,7 @@ static int8_t  lastErr1 = 0, lastErr2 = 0;
 // optional quick I2C probe to get a coarse error code
 #if OZEALIS_USE_I2C_PROBE
 static int8_t i2cProbe(uint8_t addr) {
-  Wire.beginTransmission(addr);
-  uint8_t rc = Wire.endTransmission(true);
-  // Arduino-ESP32 returns: 0 ok, 1 tooLong, 2 NACK addr, 3 NACK data, 4 other
-  switch (rc) {
-    case 0: return 0;
-    case 2: return -2;
-    case 3: return -3;
-    default: return -4;
-  }
+  return i2cWrite(addr, nullptr, 0);
 }
 #endif
 
@@ -56,62 +57,284 @@ void sensorDiagGet(uint16_t& o_miss1, uint16_t& o_miss2, int8_t& o_err1, int8_t&
   o_miss1 = miss1; o_miss2 = miss2; o_err1 = lastErr1; o_err2 = lastErr2;
 }
 
-// read both LPS22s with per-sensor cache fallback
-bool readPressures(float &pMask, float &pBlower) {
-  sensors_event_t e1_pressure, e1_temp;
-  sensors_event_t e2_pressure, e2_temp;
+// ========= LPS22HB register access =========
+static constexpr uint8_t LPS_REG_CTRL1       = 0x10;
+static constexpr uint8_t LPS_REG_CTRL2       = 0x11;
+static constexpr uint8_t LPS_REG_FIFO_CTRL   = 0x14;
+static constexpr uint8_t LPS_REG_FIFO_STATUS = 0x26;
+static constexpr uint8_t LPS_REG_PRESS_XL    = 0x28;  // P_XL,P_L,P_H,T_L,T_H, rolls back in FIFO mode
+
+static constexpr uint8_t LPS_CTRL1_BDU       = 0x02;
+static constexpr uint8_t LPS_CTRL2_FIFO_EN   = 0x40;
+static constexpr uint8_t LPS_CTRL2_ADD_INC   = 0x10;
+static constexpr uint8_t LPS_FIFO_BYPASS     = 0x00;
+static constexpr uint8_t LPS_FIFO_STREAM     = 0x40;  // F_MODE=010, oldest dropped when full
+static constexpr uint8_t LPS_FIFO_OVR        = 0x40;
+static constexpr uint8_t LPS_FIFO_FSS_MASK   = 0x3F;
+static constexpr uint8_t LPS_SLOT_BYTES      = 5;
+
+static constexpr uint8_t lpsOdrBits(uint16_t hz) {
+  return hz >= 75 ? 0x50 : hz >= 50 ? 0x40 : hz >= 25 ? 0x30 : hz >= 10 ? 0x20 : 0x10;
+}
+static constexpr uint16_t lpsOdrHz(uint16_t hz) {
+  return hz >= 75 ? 75 : hz >= 50 ? 50 : hz >= 25 ? 25 : hz >= 10 ? 10 : 1;
+}
+static constexpr uint16_t LPS_ODR_HZ      = lpsOdrHz(OZEALIS_LPS_ODR_HZ);
+static constexpr uint32_t LPS_PERIOD_US   = 1000000UL / LPS_ODR_HZ;
+static constexpr uint32_t LPS_NO_DATA_US  = 4 * LPS_PERIOD_US + 50000UL;  // empty FIFO counts as a miss after this
 
-  const bool got1 = lps1.getEvent(&e1_pressure, &e1_temp) && isfinite(e1_pressure.pressure);
-  const bool got2 = lps2.getEvent(&e2_pressure, &e2_temp) && isfinite(e2_pressure.pressure);
+static inline int8_t lpsWrite(uint8_t addr, uint8_t reg, uint8_t val) {
+  return i2cWriteReg(addr, reg, val);
+}
 
-  if (got1) {
-    pMask = e1_pressure.pressure;
-    pMask_cache = pMask;
-    lps1OK = true;
-    miss1 = 0; lastErr1 = 0;
-  } else {
+static inline int8_t lpsRead(uint8_t addr, uint8_t reg, uint8_t* buf, uint8_t n) {
+  return i2cReadReg(addr, reg, buf, n);
+}
+
+// continuous mode at LPS_ODR_HZ with the FIFO in stream mode
+static bool lpsConfigure(uint8_t addr) {
+  if (lpsWrite(addr, LPS_REG_CTRL1, 0x00) != 0) return false;  // power down while reconfiguring
+  if (lpsWrite(addr, LPS_REG_CTRL2, LPS_CTRL2_FIFO_EN | LPS_CTRL2_ADD_INC) != 0) return false;
+  if (lpsWrite(addr, LPS_REG_FIFO_CTRL, LPS_FIFO_BYPASS) != 0) return false;  // clears FIFO
+  return lpsWrite(addr, LPS_REG_FIFO_CTRL, LPS_FIFO_STREAM) == 0;
+}
+
+// start both ODR clocks back to back so FIFO slot k of each sensor is the same instant;
+// false when a sensor found at boot missed one of its writes
+static bool lpsStartSynced() {
+  int8_t e1 = 0, e2 = 0;
+  e1 |= lpsWrite(LPS_ADDR_MASK,   LPS_REG_FIFO_CTRL, LPS_FIFO_BYPASS);
+  e2 |= lpsWrite(LPS_ADDR_BLOWER, LPS_REG_FIFO_CTRL, LPS_FIFO_BYPASS);
+  e1 |= lpsWrite(LPS_ADDR_MASK,   LPS_REG_FIFO_CTRL, LPS_FIFO_STREAM);
+  e2 |= lpsWrite(LPS_ADDR_BLOWER, LPS_REG_FIFO_CTRL, LPS_FIFO_STREAM);
+  e1 |= lpsWrite(LPS_ADDR_MASK,   LPS_REG_CTRL1, lpsOdrBits(LPS_ODR_HZ) | LPS_CTRL1_BDU);
+  e2 |= lpsWrite(LPS_ADDR_BLOWER, LPS_REG_CTRL1, lpsOdrBits(LPS_ODR_HZ) | LPS_CTRL1_BDU);
+  return (e1 == 0 || !lps1Found) && (e2 == 0 || !lps2Found);
+}
+
+static int8_t lpsFifoLevel(uint8_t addr, uint8_t& level, bool& ovr) {
+  uint8_t st = 0;
+  const int8_t rc = lpsRead(addr, LPS_REG_FIFO_STATUS, &st, 1);
+  level = st & LPS_FIFO_FSS_MASK;
+  ovr   = (st & LPS_FIFO_OVR) != 0;
+  return rc;
+}
+
+// burst read n FIFO slots, keeping pressure and the newest temperature
+static int8_t lpsDrain(uint8_t addr, uint8_t n, float* p_hPa, float& temp_C) {
+  if (n == 0) return 0;
+  uint8_t raw[(LPS_BATCH_MAX + 1) * LPS_SLOT_BYTES];
+  const int8_t rc = lpsRead(addr, LPS_REG_PRESS_XL, raw, n * LPS_SLOT_BYTES);
+  if (rc != 0) return rc;
+  for (uint8_t i = 0; i < n; ++i) {
+    const uint8_t* s = &raw[i * LPS_SLOT_BYTES];
+    int32_t p = (int32_t)((uint32_t)s[2] << 24 | (uint32_t)s[1] << 16 | (uint32_t)s[0] << 8) >> 8;
+    p_hPa[i] = p / 4096.0f;
+  }
+  const uint8_t* s = &raw[(n - 1) * LPS_SLOT_BYTES];
+  temp_C = (int16_t)((uint16_t)s[4] << 8 | s[3]) / 100.0f;
+  return 0;
+}
+
+// ========= aligned sample batch =========
+static PressureSample batch[LPS_BATCH_MAX];
+static uint8_t  batchN = 0;
+static uint32_t lastSampleUs = 0;
+static uint32_t lastSlot1Us = 0, lastSlot2Us = 0;   // per side, FIFO last seen non-empty
+static bool     solo = false;                       // one side stopped producing, the other runs alone
+static float    lpsTemp1 = NAN, lpsTemp2 = NAN;
+static uint16_t fifoResyncs = 0;
+
+uint8_t sensorGetBatch(const PressureSample*& out) {
+  out = batch;
+  return batchN;
+}
+
+uint16_t sensorSampleRateHz() { return LPS_ODR_HZ; }
+
+void sensorGetLatest(float& pMask, float& pBlower) {
+  pMask   = lps1OK ? pMask_cache : NAN;
+  pBlower = lps2OK ? pBlower_cache : NAN;
+}
+
+void sensorGetTemps(float& t1, float& t2) { t1 = lpsTemp1; t2 = lpsTemp2; }
+
+// called every control tick while a side is out, so only the first miss of a
+// run is printed (and probed); the counters keep going
+static void noteMiss(uint8_t which, int8_t rc) {
+  if (which == 1) {
     lps1OK = false;
-    Serial.println("Warning: LPS22 #1 read failed, using cached value");
-    pMask = !isnan(pMask_cache) ? pMask_cache : NAN;
+    if (miss1 == 0) {
+      Serial.println("Warning: LPS22 #1 read failed, no sample");
 #if OZEALIS_USE_I2C_PROBE
-    lastErr1 = i2cProbe(0x5D);
+      lastErr1 = rc ? rc : i2cProbe(LPS_ADDR_MASK);
 #else
-    lastErr1 = -1;
+      lastErr1 = rc ? rc : -1;
 #endif
+    } else if (rc) {
+      lastErr1 = rc;
+    }
     if (miss1 < 0xFFFF) miss1++;
-  }
-
-  if (got2) {
-    pBlower = e2_pressure.pressure;
-    pBlower_cache = pBlower;
-    lps2OK = true;
-    miss2 = 0; lastErr2 = 0;
   } else {
     lps2OK = false;
-    Serial.println("Warning: LPS22 #2 read failed, using cached value");
-    pBlower = !isnan(pBlower_cache) ? pBlower_cache : NAN;
+    if (miss2 == 0) {
+      Serial.println("Warning: LPS22 #2 read failed, no sample");
 #if OZEALIS_USE_I2C_PROBE
-    lastErr2 = i2cProbe(0x5C);
+      lastErr2 = rc ? rc : i2cProbe(LPS_ADDR_BLOWER);
 #else
-    lastErr2 = -1;
+      lastErr2 = rc ? rc : -1;
 #endif
+    } else if (rc) {
+      lastErr2 = rc;
+    }
     if (miss2 < 0xFFFF) miss2++;
   }
+}
+
+// drain both LPS22 FIFOs, pair slots oldest-first and return the batch mean;
+// a failed sensor reads NAN, the cache is never handed out as a fresh sample
+static bool readPressuresClaimed(float &pMask, float &pBlower) {
+  const uint32_t now_us = micros();
+  batchN = 0;
+
+  uint8_t n1 = 0, n2 = 0;
+  bool ovr1 = false, ovr2 = false;
+  int8_t rc1 = lpsFifoLevel(LPS_ADDR_MASK, n1, ovr1);
+  int8_t rc2 = lpsFifoLevel(LPS_ADDR_BLOWER, n2, ovr2);
+
+  // a side that fails its transaction, or still answers but has stopped
+  // producing slots for too long, is left out of the pairing; the other side
+  // carries on alone, so a dead sensor degrades instead of starving both
+  if (rc1 == 0 && n1) lastSlot1Us = now_us;
+  if (rc2 == 0 && n2) lastSlot2Us = now_us;
+  bool dead1 = rc1 != 0 || (n1 == 0 && now_us - lastSlot1Us >= LPS_NO_DATA_US);
+  bool dead2 = rc2 != 0 || (n2 == 0 && now_us - lastSlot2Us >= LPS_NO_DATA_US);
+  if (dead1 && dead2) dead1 = dead2 = false;   // nothing anywhere, the empty path below
+
+  // an overrun loses slot indices, and so does a side coming back from solo;
+  // restart both clocks to realign
+  const bool both = rc1 == 0 && rc2 == 0 && !dead1 && !dead2;
+  if (both && (ovr1 || ovr2 || (solo && n1 && n2))) {
+    lpsStartSynced();
+    if (fifoResyncs < 0xFFFF) fifoResyncs++;
+    n1 = n2 = 0;
+  }
+  solo = dead1 || dead2;
+
+  // pair the oldest m slots; a surplus of one stays queued for the next call,
+  // a surplus of two or more means the ODR clocks drifted and the oldest is dropped
+  uint8_t m = both ? min(n1, n2) : (rc1 == 0 && !dead1 ? n1 : n2);
+  if (m > LPS_BATCH_MAX) m = LPS_BATCH_MAX;
+  const uint8_t skip1 = (both && n1 >= n2 + 2) ? 1 : 0;
+  const uint8_t skip2 = (both && n2 >= n1 + 2) ? 1 : 0;
+
+  float p1[LPS_BATCH_MAX + 1], p2[LPS_BATCH_MAX + 1];
+  if (rc1 == 0 && !dead1) rc1 = lpsDrain(LPS_ADDR_MASK, m + skip1, p1, lpsTemp1);
+  if (rc2 == 0 && !dead2) rc2 = lpsDrain(LPS_ADDR_BLOWER, m + skip2, p2, lpsTemp2);
+
+  const bool got1 = rc1 == 0 && !dead1 && m > 0 && isfinite(p1[skip1 + m - 1]);
+  const bool got2 = rc2 == 0 && !dead2 && m > 0 && isfinite(p2[skip2 + m - 1]);
+
+  // no new slot yet is not a failure until the FIFO has been empty too long,
+  // until then the newest sample is still current; a side that failed its
+  // transaction is still a miss
+  if ((both || solo) && m == 0 && now_us - lastSampleUs < LPS_NO_DATA_US) {
+    if (rc1 != 0) noteMiss(1, rc1);
+    if (rc2 != 0) noteMiss(2, rc2);
+    pMask = lps1OK ? pMask_cache : NAN;
+    pBlower = lps2OK ? pBlower_cache : NAN;
+    return lps1OK && lps2OK;
+  }
+
+  if (got1 || got2) {
+    // inter-sensor offset is learned on raw data and removed from the blower side,
+    // so the mask channel stays the absolute reference for ambient/gauge
+    float off = azOffset_hPa();
+    if (got1 && got2) {
+      float raw = 0.0f;
+      for (uint8_t i = 0; i < m; ++i) raw += p2[skip2 + i] - p1[skip1 + i];
+      off = azFeed(raw / m, lpsTemp1, lpsTemp2);
+    }
+
+    float sum1 = 0.0f, sum2 = 0.0f;
+    for (uint8_t i = 0; i < m; ++i) {
+      PressureSample& s = batch[i];
+      s.t_us        = now_us - (uint32_t)(m - 1 - i) * LPS_PERIOD_US;
+      s.pMask_hPa   = got1 ? p1[skip1 + i] : NAN;
+      s.pBlower_hPa = got2 ? p2[skip2 + i] - off : NAN;
+      sum1 += s.pMask_hPa;
+      sum2 += s.pBlower_hPa;
+    }
+    batchN = m;
+    lastSampleUs = now_us;
+    if (got1) pMask_cache = p1[skip1 + m - 1];
+    if (got2) pBlower_cache = p2[skip2 + m - 1] - off;
+    pMask   = sum1 / m;
+    pBlower = sum2 / m;
+  }
+
+  if (got1) {
+    lps1OK = true;
+    lastGood1Ms = millis();
+    miss1 = 0; lastErr1 = 0;
+  } else {
+    noteMiss(1, rc1);
+    pMask = NAN;
+  }
+
+  if (got2) {
+    lps2OK = true;
+    lastGood2Ms = millis();
+    miss2 = 0; lastErr2 = 0;
+  } else {
+    noteMiss(2, rc2);
+    pBlower = NAN;
+  }
 
   // freshness and debounce bookkeeping
-  if (lps1OK || lps2OK) lastGoodMs = millis();
-  if (lps1OK && lps2OK) badReadStreak = 0;
-  else if (badReadStreak < 0xFFFF) badReadStreak++;
+  if (lps1OK && lps2OK) lastGoodMs = millis();
 
   return lps1OK && lps2OK;
 }
 
+bool readPressures(float &pMask, float &pBlower) {
+  if (!i2cClaim(I2C_PRIO_PRESSURE)) {
+    // bus held past its budget, report the newest sample without a miss;
+    // a side already failed stays NAN, as on an empty FIFO
+    batchN = 0;
+    pMask = lps1OK ? pMask_cache : NAN;
+    pBlower = lps2OK ? pBlower_cache : NAN;
+    return lps1OK && lps2OK;
+  }
+  const bool ok = readPressuresClaimed(pMask, pBlower);
+  i2cRelease();
+  return ok;
+}
+
+// after a bus reset the sensors may have seen a torn transaction, restart them;
+// lpsConfigure() powers a sensor down first, so a partial run is retried by
+// i2cbus at the next pressure claim rather than left standing
+static bool lpsReinit() {
+  bool ok = true;
+  if (lps1Found) ok &= lpsConfigure(LPS_ADDR_MASK);
+  if (lps2Found) ok &= lpsConfigure(LPS_ADDR_BLOWER);
+  return lpsStartSynced() && ok;
+}
+
 // debounced health for state machine
 bool sensorsOK() {
-  const uint32_t age = millis() - lastGoodMs;
-  if (lps1OK && lps2OK) return true;
-  if (badReadStreak < SENSOR_FAIL_DEBOUNCE && age < STALE_MS) return true;
-  return false;
+  return (lps1OK && lps2OK) || millis() - lastGoodMs < SENSOR_FAIL_DEBOUNCE_MS;
+}
+
+// same debounce applied to each side on its own
+SensorHealth sensorHealth() {
+  const uint32_t now = millis();
+  const bool ok1 = lps1OK || now - lastGood1Ms < SENSOR_FAIL_DEBOUNCE_MS;
+  const bool ok2 = lps2OK || now - lastGood2Ms < SENSOR_FAIL_DEBOUNCE_MS;
+  if (ok1 && ok2) return SENSE_BOTH;
+  if (ok1) return SENSE_MASK_ONLY;
+  if (ok2) return SENSE_BLOWER_ONLY;
+  return SENSE_NONE;
 }
 
 // convenience helpers
@@ -131,17 +354,144 @@ float getPressureDiffCached() {
 }
 
 // VIN
-float readVIN() {
-  const uint16_t raw = analogRead(VIN_SEN);
-  return (raw * (3.3f / 4095.0f)) * VIN_DIVIDER_RATIO;
+float readVIN() { return vinFast; }
+
+float vinFiltered() { return vinLP; }
+
+static void IRAM_ATTR vinFrameISR() {
+  if (!vinTask) return;
+  BaseType_t hpw = pdFALSE;
+  vTaskNotifyGiveFromISR(vinTask, &hpw);
+  if (hpw) portYIELD_FROM_ISR();
+}
+
+static inline void vinPush(float mv, bool seed) {
+  const float v = mv * 0.001f * VIN_DIVIDER_RATIO;
+  vinFast = v;
+  vinLP = seed ? v : vinLP + VIN_ALPHA * (v - vinLP);
 }
 
-float vinFiltered() {
-  const float now = readVIN();
-  vinLP = vinLP * (1.0f - VIN_ALPHA) + now * VIN_ALPHA;
-  return vinLP;
+static void vinAcqTask(void*) {
+  bool seeded = false;
+  TickType_t wake = xTaskGetTickCount();
+  for (;;) {
+    if (vinDma) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      adc_continuous_data_t* res = nullptr;
+      if (analogContinuousRead(&res, 0) && res) {
+        vinPush((float)res[0].avg_read_mvolts, !seeded);
+        seeded = true;
+      }
+    } else {
+      // same frame rate, oversampled by hand
+      vTaskDelayUntil(&wake, pdMS_TO_TICKS(1000 / (uint32_t)VIN_FRAME_HZ));
+      uint32_t mv = 0;
+      for (uint8_t i = 0; i < 8; ++i) mv += analogReadMilliVolts(VIN_SEN);
+      vinPush(mv / 8.0f, !seeded);
+      seeded = true;
+    }
+  }
+}
+
+static void setupVIN() {
+  // seed both values so the first loop never sees 0 V (one-shot before DMA owns the pin)
+  vinPush((float)analogReadMilliVolts(VIN_SEN), true);
+
+  const uint8_t pins[] = { VIN_SEN };
+  vinDma = analogContinuous(pins, 1, VIN_ADC_OVERSAMPLE, VIN_ADC_SAMPLE_HZ, &vinFrameISR);
+  Serial.println(vinDma ? "VIN: ADC DMA running" : "VIN: ADC DMA unavailable, polled fallback");
+
+  xTaskCreatePinnedToCore(vinAcqTask, "vin_adc", 2048, nullptr, 2, &vinTask, 1);
+  if (vinDma) analogContinuousStart();
+}
+
+// ========= AHT20 state machine =========
+enum AhtState : uint8_t { AHT_OFF = 0, AHT_WAIT_PERIOD, AHT_CONVERTING };
+
+static constexpr uint32_t AHT_CONV_MS     = 80;   // datasheet conversion time
+static constexpr uint32_t AHT_TIMEOUT_MS  = 250;  // still busy after this → abandon frame
+
+static AhtState ahtState = AHT_OFF;
+static uint32_t ahtPeriodMs = AHT_DEFAULT_PERIOD_MS;
+static uint32_t ahtStampMs = 0;     // last trigger (or failed attempt)
+static uint32_t ahtGoodMs = 0;
+static float    inletTemp = NAN, inletRH = NAN;
+static uint16_t ahtCrcErr = 0, ahtBusErr = 0;
+
+// CRC-8, poly 0x31, init 0xFF
+static uint8_t ahtCrc8(const uint8_t* d, uint8_t n) {
+  uint8_t crc = 0xFF;
+  for (uint8_t i = 0; i < n; ++i) {
+    crc ^= d[i];
+    for (uint8_t b = 0; b < 8; ++b) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+static bool ahtTrigger() {
+  static const uint8_t cmd[3] = { 0xAC, 0x33, 0x00 };
+  return i2cWrite(AHT_ADDR, cmd, 3) == 0;
 }
 
+static void ahtStep();
+
+// one short transaction per call, never waits on the sensor or a busy bus
+void ahtService() {
+  if (ahtState == AHT_OFF || !i2cClaim(I2C_PRIO_AMBIENT)) return;
+  ahtStep();
+  i2cRelease();
+}
+
+static void ahtStep() {
+  const uint32_t now = millis();
+  switch (ahtState) {
+    case AHT_OFF:
+      return;
+
+    case AHT_WAIT_PERIOD:
+      if (now - ahtStampMs < ahtPeriodMs) return;  // stamp = previous trigger
+      if (ahtTrigger()) {
+        ahtStampMs = now;
+        ahtState = AHT_CONVERTING;
+      } else if (ahtBusErr < 0xFFFF) {
+        ahtBusErr++;
+        ahtStampMs = now;
+      }
+      return;
+
+    case AHT_CONVERTING: {
+      if (now - ahtStampMs < AHT_CONV_MS) return;
+      uint8_t d[7];
+      if (i2cRead(AHT_ADDR, d, 7) != 0) {
+        if (ahtBusErr < 0xFFFF) ahtBusErr++;
+        ahtState = AHT_WAIT_PERIOD;
+        return;
+      }
+      if (d[0] & 0x80) {  // still busy, try again next loop
+        if (now - ahtStampMs > AHT_TIMEOUT_MS) ahtState = AHT_WAIT_PERIOD;
+        return;
+      }
+      ahtState = AHT_WAIT_PERIOD;
+      if (ahtCrc8(d, 6) != d[6]) {
+        if (ahtCrcErr < 0xFFFF) ahtCrcErr++;
+        return;
+      }
+      const uint32_t h = ((uint32_t)d[1] << 12) | ((uint32_t)d[2] << 4) | (d[3] >> 4);
+      const uint32_t t = ((uint32_t)(d[3] & 0x0F) << 16) | ((uint32_t)d[4] << 8) | d[5];
+      inletRH   = h * (100.0f / 1048576.0f);
+      inletTemp = t * (200.0f / 1048576.0f) - 50.0f;
+      ahtGoodMs = now;
+      return;
+    }
+  }
+}
+
+void ahtSetPeriod(uint32_t ms) { ahtPeriodMs = max<uint32_t>(ms, 100); }
+float sensorInletTemp_C() { return inletTemp; }
+float sensorInletRH() { return inletRH; }
+uint32_t sensorInletAgeMs() { return ahtGoodMs ? millis() - ahtGoodMs : UINT32_MAX; }
+void ahtDiagGet(uint16_t& crcErr, uint16_t& busErr) { crcErr = ahtCrcErr; busErr = ahtBusErr; }
+
 // ambient estimate accessors
 float sensorAmbient_hPa() { return ambient_hPa; }
 
@@ -163,29 +513,46 @@ void sensorUpdateAmbientEstimate(float pMask, float diff_hPa) {
 
 // setup
 void setupSensors() {
-  Wire.begin(IIC_SDA, IIC_SCL);
+  i2cBusBegin();
+  i2cOnRecover(lpsReinit);
 
-  lps1OK = lps1.begin_I2C(0x5D);
+  // Adafruit driver for probe and reset, then our own FIFO configuration
+  lps1Found = lps1.begin_I2C(LPS_ADDR_MASK);
+  lps1OK = lps1Found && lpsConfigure(LPS_ADDR_MASK);
   Serial.println(lps1OK ? "LPS22 #1 OK" : "LPS22 #1 not found");
 
-  lps2OK = lps2.begin_I2C(0x5C);
+  lps2Found = lps2.begin_I2C(LPS_ADDR_BLOWER);
+  lps2OK = lps2Found && lpsConfigure(LPS_ADDR_BLOWER);
   Serial.println(lps2OK ? "LPS22 #2 OK" : "LPS22 #2 not found");
 
+  lpsStartSynced();
+  Serial.printf("LPS22 FIFO stream at %u Hz\n", (unsigned)LPS_ODR_HZ);
+
+  // blocking begin() only once for calibration, measurements go through ahtService()
   const bool ahtOK = aht.begin();
   Serial.println(ahtOK ? "AHT20 OK" : "AHT20 not found");
+  if (ahtOK) {
+    ahtState = AHT_WAIT_PERIOD;
+    ahtStampMs = millis() - ahtPeriodMs;  // first frame right away
+  }
+
+  // offset model must be loaded before the first corrected sample
+  azBegin();
 
-  // prime caches if possible
+  // prime caches if possible, after the first slots land
+  lastSlot1Us = lastSlot2Us = micros();
+  delay(3 * LPS_PERIOD_US / 1000);
   float pm, pb;
   if (readPressures(pm, pb)) {
     pMask_cache = pm;
     pBlower_cache = pb;
   }
   if (lps1OK || lps2OK) {
-    lastGoodMs = millis();
+    lastGoodMs = lastGood1Ms = lastGood2Ms = millis();   // one debounce window to come up
     if (!ambientInit && isfinite(pMask_cache)) { ambient_hPa = pMask_cache; ambientInit = true; }
   }
 
-  vinLP = readVIN();
+  setupVIN();
 
 }
 
@@ -193,4 +560,4 @@ void setupSensors() {
 float cmH2O_to_hPa(float cm) { return cm * 0.980665f; }  // convenience
 float hPa_to_cmH2O(float hPa) { return hPa * 1.019716f; } // convenience
 
-// (cache fallback, debounce, ambient estimator, and I2C probe). Jérémie Fréreault - 2025-08-10
+// (cache fallback, debounce, ambient estimator, FIFO drain, and I2C probe). Jérémie Fréreault - 2025-08-10
@@ -6,30 +6,60 @@
 #include <Wire.h>
 #include <Adafruit_LPS2X.h>
 #include <Adafruit_AHTX0.h>
+#include "i2cbus.h"   // IIC pins, bus claims and accounted transactions
 
-// I2C pins
-#define IIC_SDA 21
-#define IIC_SCL 22
+// LPS22 addresses
+#define LPS_ADDR_MASK   0x5D
+#define LPS_ADDR_BLOWER 0x5C
+
+// LPS22 continuous sampling rate, one of 1, 10, 25, 50, 75 Hz
+#ifndef OZEALIS_LPS_ODR_HZ
+#define OZEALIS_LPS_ODR_HZ 75
+#endif
+
+// max aligned pairs drained per readPressures(), bounded by the 128 byte Wire buffer
+#define LPS_BATCH_MAX 24
 
 // VIN monitor
 #define VIN_SEN 35
 #define VIN_DIVIDER_RATIO 11.0f
+#define VIN_ADC_SAMPLE_HZ 20000   // ADC DMA rate, ESP32 minimum
+#define VIN_ADC_OVERSAMPLE 80     // conversions averaged per frame → 250 Hz frames
 
 // Global sensor objects
 extern Adafruit_LPS22 lps1;   // upstream mask side
 extern Adafruit_LPS22 lps2;   // downstream blower side
 extern Adafruit_AHTX0 aht;
 
+// One time-aligned mask/blower pair drained from the LPS22 FIFOs
+struct PressureSample {
+  uint32_t t_us;        // estimated sample instant, micros()
+  float    pMask_hPa;   // mask absolute, NAN if that sensor failed
+  float    pBlower_hPa; // blower absolute, NAN if that sensor failed
+};
+
 // Setup
 void setupSensors();  // call once in setup()
 
 // VIN
-float readVIN();       // instantaneous VIN in volts
-float vinFiltered();   // low pass filtered VIN
+float readVIN();       // latest oversampled frame, volts, constant time
+float vinFiltered();   // low pass filtered VIN, constant time
 
 // Pressure IO
-bool  readPressures(float &pMask_hPa, float &pBlower_hPa);  // per call read
-bool  sensorsOK();                                         // debounced health
+bool  readPressures(float &pMask_hPa, float &pBlower_hPa);  // drain FIFOs, batch mean, NAN on fail
+uint8_t sensorGetBatch(const PressureSample*& out);        // pairs drained by last readPressures()
+void  sensorGetLatest(float &pMask_hPa, float &pBlower_hPa); // newest drained pair, no bus access, NAN if failing
+uint16_t sensorSampleRateHz();                             // configured LPS22 ODR
+bool  sensorsOK();                                         // debounced health, both sides
+
+// Per-side debounced health, drives the single-sensor degraded mode
+enum SensorHealth : uint8_t {
+  SENSE_BOTH = 0,
+  SENSE_MASK_ONLY,     // blower LPS22 lost
+  SENSE_BLOWER_ONLY,   // mask LPS22 lost
+  SENSE_NONE
+};
+SensorHealth sensorHealth();
 float getPressureDiff();                                   // blower − mask hPa
 float getPressureDiffCached();                             // cached diff hPa
 
@@ -37,6 +67,19 @@ float getPressureDiffCached();                             // cached diff hPa
 float sensorAmbient_hPa();                                 // current ambient estimate
 void  sensorUpdateAmbientEstimate(float pMask_hPa, float diff_hPa); // call each loop
 
+// LPS22 die temperatures from the last FIFO drain (°C)
+void  sensorGetTemps(float& tMask_C, float& tBlower_C);
+
+// Inlet AHT20, non-blocking trigger/wait/fetch with CRC check
+#define AHT_ADDR 0x38
+#define AHT_DEFAULT_PERIOD_MS 2000
+void  ahtService();                     // call each loop right after readPressures()
+void  ahtSetPeriod(uint32_t period_ms);  // publish rate, >= 100 ms
+float sensorInletTemp_C();              // NAN until first good frame
+float sensorInletRH();                  // %RH, NAN until first good frame
+uint32_t sensorInletAgeMs();            // age of the published values
+void  ahtDiagGet(uint16_t& crcErr, uint16_t& busErr);
+
 // Unit conversion helpers
 float cmH2O_to_hPa(float cm);
 float hPa_to_cmH2O(float hPa);
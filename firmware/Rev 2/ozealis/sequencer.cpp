@@ -0,0 +1,102 @@
+// sequencer.cpp – implementation
+#include "sequencer.h"
+#include "buzzer.h"  // buzzerSet()
+#include "led.h"     // ledOverlay()
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+
+static esp_timer_handle_t timer = nullptr;
+static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+
+static SeqPattern cur{};
+static SeqPattern pending{};
+static bool     active = false, hasPending = false;
+static uint16_t step = 0;   // even = on, odd = off
+static int64_t  dueUs = 0;  // end of the current step, esp_timer clock
+
+/*  Two tasks restart the one timer: the callback at each step and
+    seqPlay() to cut a step short. esp_timer_start_once() on an armed
+    timer fails with ESP_ERR_INVALID_STATE, so whichever start lands
+    second is lost. Both sides therefore stop, then start, and ignore the
+    result; the callback re‑checks for a posted pattern after its own
+    restart, and a fire before dueUs (a kick that lost to nobody) only
+    re‑arms for the rest of the step.                                      */
+static void arm(uint64_t us) {
+  esp_timer_stop(timer);
+  esp_timer_start_once(timer, us);
+}
+
+// all stepping happens here, in the esp_timer task; seqPlay() only posts
+static void onStep(void*) {
+  bool on = false, done = false, fresh = false, early = false;
+  int64_t due = 0;
+  SeqPattern p;
+  const int64_t now = esp_timer_get_time();
+
+  portENTER_CRITICAL(&mux);
+  if (hasPending) {
+    cur = pending;
+    hasPending = false;
+    active = true;
+    fresh = true;
+    step = 0;
+  } else if (active && now < dueUs) {
+    early = true;
+  } else if (active) {
+    step++;
+    if ((step & 1) && cur.off_ms == 0) step++;   // no gap between repeats
+    if (step >= 2 * cur.count) active = false;
+  }
+  done = !active;
+  p = cur;
+  on = !(step & 1);
+  if (!done && !early) dueUs = now + (int64_t)max<uint32_t>(1, on ? p.on_ms : p.off_ms) * 1000;
+  due = dueUs;
+  portEXIT_CRITICAL(&mux);
+
+  if (done) {
+    buzzerSet(false);
+    ledOverlay(false, 0);
+    return;
+  }
+  if (!early) {
+    buzzerSet(p.tone && on);
+    if (p.rgb != SEQ_NO_LED) ledOverlay(true, on ? p.rgb : 0x000000);
+    else if (fresh) ledOverlay(false, 0);   // the pattern replaced may have had the LEDs
+  }
+  arm((uint64_t)(due - now));
+
+  // a seqPlay() between our lock and our restart may have lost its kick
+  portENTER_CRITICAL(&mux);
+  const bool again = hasPending;
+  portEXIT_CRITICAL(&mux);
+  if (again) arm(0);
+}
+
+// ------------------------------------------------
+void seqBegin() {
+  const esp_timer_create_args_t args = { onStep, nullptr, ESP_TIMER_TASK, "seq", false };
+  esp_timer_create(&args, &timer);
+}
+
+bool seqPlay(const SeqPattern& p) {
+  if (!timer || p.count == 0) return false;
+  portENTER_CRITICAL(&mux);
+  const SeqPrio playing = hasPending ? max(pending.prio, active ? cur.prio : SEQ_INFO)
+                                     : active ? cur.prio : SEQ_INFO;
+  const bool take = !(active || hasPending) || p.prio >= playing;
+  if (take) {
+    pending = p;
+    hasPending = true;
+  }
+  portEXIT_CRITICAL(&mux);
+  if (!take) return false;
+
+  // cut the current step short, the callback picks the pattern up at once
+  arm(0);
+  return true;
+}
+
+bool seqBusy() {
+  return active || hasPending;
+}
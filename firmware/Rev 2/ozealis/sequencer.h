@@ -0,0 +1,43 @@
+// sequencer.h – non‑blocking buzzer/LED patterns with priorities
+#ifndef SEQUENCER_H
+#define SEQUENCER_H
+
+#include <Arduino.h>
+
+/*  A pattern is count × (on_ms, off_ms): buzzer on and/or the LEDs
+    overlaid with one colour during "on", silent/dark during "off". Steps
+    are timed by a one‑shot esp_timer (hardware timer backed), so
+    seqPlay() returns at once from any task, the control task included.
+    A pattern of equal or higher priority replaces the one playing, a
+    lower one is dropped. When a pattern ends the LEDs fall back to the
+    mode colour set with setLED().                                         */
+
+enum SeqPrio : uint8_t {
+  SEQ_INFO = 0,
+  SEQ_NOTICE,
+  SEQ_ALARM
+};
+
+constexpr uint32_t SEQ_NO_LED = 0xFFFFFFFF;   // leave the LEDs to setLED()
+
+struct SeqPattern {
+  uint8_t  count;
+  uint16_t on_ms, off_ms;
+  bool     tone;
+  uint32_t rgb;        // 0xRRGGBB overlay while on, or SEQ_NO_LED
+  SeqPrio  prio;
+};
+
+constexpr SeqPattern SEQ_FAULT_VIN     = { 2, 80, 120, true, SEQ_NO_LED, SEQ_ALARM };
+constexpr SeqPattern SEQ_FAULT_SENSOR  = { 3, 80, 120, true, SEQ_NO_LED, SEQ_ALARM };
+constexpr SeqPattern SEQ_FAULT_OVERP   = { 5, 80, 120, true, SEQ_NO_LED, SEQ_ALARM };
+constexpr SeqPattern SEQ_FAULT_OTHER   = { 1, 80, 120, true, SEQ_NO_LED, SEQ_ALARM };
+constexpr SeqPattern SEQ_NOTICE_BEEP   = { 1, 80, 0,   true, SEQ_NO_LED, SEQ_NOTICE };
+constexpr SeqPattern SEQ_SHUTDOWN      = { 1, 500, 0,  false, 0xFF9600, SEQ_INFO };    // orange
+constexpr SeqPattern SEQ_ERASE         = { 5, 150, 150, false, 0xFF0000, SEQ_ALARM };  // red blinks
+
+void seqBegin();                        // after setupBuzzer() and setupLED()
+bool seqPlay(const SeqPattern& p);      // false = dropped, lower priority than the one playing
+bool seqBusy();
+
+#endif  // SEQUENCER_H
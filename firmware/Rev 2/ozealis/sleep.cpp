@@ -0,0 +1,192 @@
+// sleep.cpp – implementation
+#include "sleep.h"
+#include "breath.h"  // breathSeq(), breathGet()
+#include "apnea.h"   // apneaSeq()
+#include <Preferences.h>
+#include <math.h>
+
+static Preferences usagePrefs;   // NVS namespace "usage"
+
+// sliding window of per‑breath values, running Σx and Σx²
+struct Window {
+  float  x[SLEEP_WINDOW];
+  double sum, sum2;
+  uint8_t head, n;
+};
+static Window period{}, vt{};
+
+static bool     asleep = false;
+static uint8_t  streak = 0;          // consecutive breaths voting for the other state
+static float    cvPeriod = NAN, cvVt = NAN;
+static uint32_t seenBreath = 0, seenEvent = 0;
+static uint32_t onsetMs = 0, sessionMs = 0, lastTherapyMs = 0;
+static uint32_t lastTickMs = 0, lastSaveMs = 0;
+static uint32_t therapyAcc_ms = 0, sleepAcc_ms = 0;   // sub‑second remainders
+static SleepUsage usage{};
+static volatile bool endReq = false;
+
+static void winClear(Window& w) { w = Window{}; }
+
+static void winPush(Window& w, float v) {
+  if (w.n == SLEEP_WINDOW) {
+    const float old = w.x[w.head];
+    w.sum -= old;
+    w.sum2 -= (double)old * old;
+  } else {
+    w.n++;
+  }
+  w.x[w.head] = v;
+  w.sum += v;
+  w.sum2 += (double)v * v;
+  w.head = (w.head + 1) % SLEEP_WINDOW;
+}
+
+static float winCv(const Window& w) {
+  if (w.n < SLEEP_WINDOW || w.sum <= 0.0) return NAN;
+  const double mean = w.sum / w.n;
+  const double var = max(0.0, w.sum2 / w.n - mean * mean);
+  return (float)(sqrt(var) / mean);
+}
+
+static void saveUsage() {
+  usagePrefs.begin("usage", false);
+  usagePrefs.putULong("therapyS", usage.totalTherapy_s);
+  usagePrefs.putULong("sleepS", usage.totalSleep_s);
+  usagePrefs.putULong("sessions", usage.sessions);
+  usagePrefs.putULong("sessT", usage.sessionTherapy_s);
+  usagePrefs.putULong("sessS", usage.sessionSleep_s);
+  usagePrefs.putBool("open", sessionMs != 0);
+  usagePrefs.end();
+  lastSaveMs = millis();
+}
+
+static void endSession() {
+  sessionMs = onsetMs = 0;
+  winClear(period);
+  winClear(vt);
+  cvPeriod = cvVt = NAN;
+  saveUsage();
+}
+
+static void enterSleep(uint32_t now) {
+  asleep = true;
+  streak = 0;
+  if (!onsetMs) onsetMs = now;
+}
+
+// ------------------------------------------------
+void sleepBegin() {
+  usagePrefs.begin("usage", true);
+  usage.totalTherapy_s = usagePrefs.getULong("therapyS", 0);
+  usage.totalSleep_s = usagePrefs.getULong("sleepS", 0);
+  usage.sessions = usagePrefs.getULong("sessions", 0);
+  usage.sessionTherapy_s = usagePrefs.getULong("sessT", 0);
+  usage.sessionSleep_s = usagePrefs.getULong("sessS", 0);
+  const bool open = usagePrefs.getBool("open", false);
+  usagePrefs.end();
+  seenBreath = breathSeq();
+  seenEvent = apneaSeq();
+  Serial.printf("Usage: %.1f h therapy, %.1f h asleep, %lu sessions\n", usage.totalTherapy_s / 3600.0f,
+                usage.totalSleep_s / 3600.0f, (unsigned long)usage.sessions);
+  if (open) {
+    // cut by a reset or power loss, up to SLEEP_SAVE_MS of it is gone
+    Serial.printf("Usage: session %lu closed at boot, %.1f h therapy\n", (unsigned long)usage.sessions,
+                  usage.sessionTherapy_s / 3600.0f);
+    endSession();
+  }
+}
+
+void sleepService(bool therapy) {
+  const uint32_t now = millis();
+  const uint32_t dt = lastTickMs ? now - lastTickMs : 0;
+  lastTickMs = now;
+
+  if (endReq) {
+    endReq = false;
+    if (sessionMs) {
+      asleep = false;
+      streak = 0;
+      endSession();
+    }
+  }
+
+  if (!therapy) {
+    asleep = false;
+    streak = 0;
+    seenBreath = breathSeq();
+    seenEvent = apneaSeq();
+    // end of the night: the next therapy starts a new session
+    if (sessionMs && now - lastTherapyMs >= SLEEP_SESSION_GAP_MS) endSession();
+    return;
+  }
+
+  if (!sessionMs) {
+    sessionMs = max<uint32_t>(1, now);
+    usage.sessions++;
+    usage.sessionTherapy_s = usage.sessionSleep_s = 0;
+    therapyAcc_ms = sleepAcc_ms = 0;
+    saveUsage();   // open from here, a reset closes it at boot
+  }
+  lastTherapyMs = now;
+
+  // usage, whole seconds out of millisecond accumulators
+  therapyAcc_ms += dt;
+  if (asleep) sleepAcc_ms += dt;
+  const uint32_t tS = therapyAcc_ms / 1000, sS = sleepAcc_ms / 1000;
+  therapyAcc_ms -= tS * 1000;
+  sleepAcc_ms -= sS * 1000;
+  usage.sessionTherapy_s += tS;
+  usage.totalTherapy_s += tS;
+  usage.sessionSleep_s += sS;
+  usage.totalSleep_s += sS;
+  if (now - lastSaveMs >= SLEEP_SAVE_MS) saveUsage();
+
+  // a scored event is sleep by definition
+  const uint32_t eSeq = apneaSeq();
+  if (eSeq != seenEvent) {
+    seenEvent = eSeq;
+    if (!asleep) enterSleep(now);
+  }
+
+  // per breath: update the windows, vote
+  BreathRecord r;
+  const uint32_t bSeq = breathSeq();
+  if (bSeq - seenBreath > BREATH_RING) seenBreath = bSeq - BREATH_RING;
+  for (; seenBreath < bSeq; ++seenBreath) {
+    if (!breathGet(seenBreath, r)) continue;
+    winPush(period, (r.ti_ms + r.te_ms) * 1e-3f);
+    winPush(vt, r.vt_mL);
+    cvPeriod = winCv(period);
+    cvVt = winCv(vt);
+    if (isnan(cvPeriod) || isnan(cvVt)) continue;
+
+    const bool vote = asleep ? (cvPeriod > WAKE_CV_PERIOD || cvVt > WAKE_CV_VT)
+                             : (cvPeriod < SLEEP_CV_PERIOD && cvVt < SLEEP_CV_VT);
+    streak = vote ? streak + 1 : 0;
+    if (streak >= SLEEP_CONFIRM) {
+      if (asleep) {
+        asleep = false;
+        streak = 0;
+      } else {
+        enterSleep(now);
+      }
+    }
+  }
+}
+
+bool     sleepAsleep()         { return asleep; }
+uint32_t sleepOnsetMs()        { return onsetMs; }
+uint32_t sleepSessionStartMs() { return sessionMs; }
+float    sleepCvPeriod()       { return cvPeriod; }
+float    sleepCvVt()           { return cvVt; }
+const SleepUsage& sleepUsage() { return usage; }
+
+void sleepEndSession() {
+  endReq = true;
+}
+
+void sleepResetUsage() {
+  usage = SleepUsage{};
+  therapyAcc_ms = sleepAcc_ms = 0;
+  saveUsage();
+}
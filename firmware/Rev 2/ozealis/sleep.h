@@ -0,0 +1,51 @@
+// sleep.h – sleep onset from breathing regularity, usage hours
+#ifndef SLEEP_H
+#define SLEEP_H
+
+#include <Arduino.h>
+
+/*  Awake breathing is irregular: sighs, talking, swallowing, position
+    changes. Asleep, breath period and tidal volume settle. Per completed
+    breath the last SLEEP_WINDOW periods and volumes keep running sums, so
+    the coefficient of variation (σ/mean) of each is O(1) to update.
+      asleep  both CVs under the SLEEP_* limits for SLEEP_CONFIRM breaths,
+              or a scored apnea/hypopnea (they only happen asleep)
+      awake   either CV over the WAKE_* limits for SLEEP_CONFIRM breaths
+    A session is therapy time with gaps shorter than SLEEP_SESSION_GAP_MS,
+    so a mask adjustment or a bathroom trip doesn't start a new night. A
+    stop from the button or an auto‑stop ends it at once (sleepEndSession()).
+    Usage (therapy = blower on, mask on; sleep = therapy while asleep) is
+    kept per session and in total in NVS, written at the end of a session
+    and every SLEEP_SAVE_MS with an "open" mark; a session still open at
+    boot was cut by a reset or power loss and is closed there.             */
+
+constexpr uint8_t  SLEEP_WINDOW         = 20;       // breaths, ~1.5 min
+constexpr float    SLEEP_CV_PERIOD      = 0.15f;
+constexpr float    SLEEP_CV_VT          = 0.25f;
+constexpr float    WAKE_CV_PERIOD       = 0.30f;
+constexpr float    WAKE_CV_VT           = 0.45f;
+constexpr uint8_t  SLEEP_CONFIRM        = 5;        // consecutive breaths
+constexpr uint32_t SLEEP_SESSION_GAP_MS = 900000;   // 15 min
+constexpr uint32_t SLEEP_SAVE_MS        = 300000;   // 5 min, ~100 NVS writes a night
+constexpr uint32_t SLEEP_HOLD_MAX_MS    = 1800000;  // auto‑ramp: ramp anyway after this
+
+struct SleepUsage {
+  uint32_t sessionTherapy_s;
+  uint32_t sessionSleep_s;
+  uint32_t totalTherapy_s;   // NVS, all sessions
+  uint32_t totalSleep_s;
+  uint32_t sessions;
+};
+
+void  sleepBegin();                 // loads the usage totals
+void  sleepService(bool therapy);   // from loop(); therapy = blower on with the mask on
+void  sleepEndSession();            // any task; taken at the next sleepService()
+bool  sleepAsleep();
+uint32_t sleepOnsetMs();            // first onset this session (millis), 0 = not yet
+uint32_t sleepSessionStartMs();     // 0 = no session
+float sleepCvPeriod();
+float sleepCvVt();
+const SleepUsage& sleepUsage();
+void  sleepResetUsage();
+
+#endif  // SLEEP_H
@@ -0,0 +1,114 @@
+// snore.cpp – implementation
+#include "snore.h"
+#include "sensor.h"  // sensorSampleRateHz()
+#include <math.h>
+
+static bool     enabled = false;
+static int32_t  coef[SNORE_BINS];       // 2cos(2πk/N), Q14
+static float    gain[SNORE_BINS];       // 1/|1 − e^−jω|², undoes the differencer per bin
+static int32_t  s1[SNORE_BINS], s2[SNORE_BINS];
+static uint8_t  nBlock = 0;
+static bool     havePrev = false;
+static float    prevP = 0.0f;
+static bool     inInsp = false;
+
+static float    floorE = 0.0f;          // expiratory block energy, counts²
+static uint8_t  floorBlocks = 0;
+static double   inspE = 0.0;
+static uint16_t inspBlocks = 0;
+
+static uint32_t breathCycles = 0;
+static SnoreStats stats{};
+
+static void clearBlock() {
+  for (uint8_t k = 0; k < SNORE_BINS; ++k) s1[k] = s2[k] = 0;
+  nBlock = 0;
+}
+
+// mean square of the pressure in the bins, counts² (1/4096 hPa)
+static float blockEnergy() {
+  float p = 0.0f;
+  for (uint8_t k = 0; k < SNORE_BINS; ++k) {
+    const int64_t a = s1[k], b = s2[k];
+    p += gain[k] * (float)(a * a + b * b - ((coef[k] * a * b) >> 14));
+  }
+  return 2.0f * p / (SNORE_BLOCK * SNORE_BLOCK);
+}
+
+// ------------------------------------------------
+void snoreBegin() {
+  enabled = sensorSampleRateHz() >= SNORE_MIN_ODR_HZ;
+  for (uint8_t k = 0; k < SNORE_BINS; ++k) {
+    const float w = 2.0f * PI * SNORE_BIN_K[k] / SNORE_BLOCK;
+    coef[k] = (int32_t)lroundf(2.0f * cosf(w) * 16384.0f);
+    gain[k] = 1.0f / (2.0f - 2.0f * cosf(w));
+  }
+  clearBlock();
+  Serial.printf("Snore: %s, %u-%u Hz\n", enabled ? "on" : "off (ODR too low)",
+                (unsigned)(SNORE_BIN_K[0] * sensorSampleRateHz() / SNORE_BLOCK),
+                (unsigned)(SNORE_BIN_K[SNORE_BINS - 1] * sensorSampleRateHz() / SNORE_BLOCK));
+}
+
+void snorePhase(bool insp) {
+  inInsp = insp;
+  havePrev = false;
+  clearBlock();
+}
+
+void snoreAdd(float p) {
+  if (!enabled) return;
+  const uint32_t c0 = ESP.getCycleCount();
+
+  if (!havePrev) {
+    prevP = p;
+    havePrev = true;
+    return;
+  }
+  const int32_t x = constrain((int32_t)lroundf((p - prevP) * 4096.0f), -8191, 8191);
+  prevP = p;
+
+  for (uint8_t k = 0; k < SNORE_BINS; ++k) {
+    const int32_t s0 = x + (int32_t)(((int64_t)coef[k] * s1[k]) >> 14) - s2[k];
+    s2[k] = s1[k];
+    s1[k] = s0;
+  }
+
+  if (++nBlock >= SNORE_BLOCK) {
+    const float e = blockEnergy();
+    if (inInsp) {
+      inspE += e;
+      inspBlocks++;
+    } else {
+      floorE = floorBlocks ? floorE + SNORE_FLOOR_ALPHA * (e - floorE) : e;
+      if (floorBlocks < 0xFF) floorBlocks++;
+    }
+    clearBlock();
+  }
+  breathCycles += ESP.getCycleCount() - c0;
+}
+
+SnoreResult snoreInspDone() {
+  SnoreResult r{};
+  if (enabled && inspBlocks && floorBlocks >= 4) {
+    const float e = (float)(inspE / inspBlocks);
+    r.index  = e / max(floorE, 1.0f);
+    r.rms_Pa = sqrtf(e) * (100.0f / 4096.0f);
+    r.snore  = r.index > SNORE_RATIO_TH && r.rms_Pa > SNORE_MIN_PA;
+    r.valid  = true;
+  }
+  inspE = 0.0;
+  inspBlocks = 0;
+
+  // one call per breath, so this closes the breath's CPU account too
+  const uint32_t us = breathCycles / getCpuFrequencyMhz();
+  breathCycles = 0;
+  stats.avg_us = stats.avg_us > 0.0f ? stats.avg_us + 0.1f * (us - stats.avg_us) : us;
+  stats.max_us = max(stats.max_us, us);
+  return r;
+}
+
+const SnoreStats& snoreGetStats() { return stats; }
+
+void snoreStatsReset() {
+  stats.max_us = 0;
+}
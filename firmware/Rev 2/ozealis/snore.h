@@ -0,0 +1,47 @@
+// snore.h – airway vibration index from the mask pressure stream
+#ifndef SNORE_H
+#define SNORE_H
+
+#include <Arduino.h>
+
+/*  Snoring and partial obstruction vibrate the mask pressure well above
+    the breathing frequency. Every mask FIFO sample (LPS22 at its 75 Hz
+    maximum, the batch is already drained at full rate) is first‑differenced
+    to drop the breathing swing, then fed to SNORE_BINS fixed‑point Goertzel
+    filters over SNORE_BLOCK‑sample blocks, ~15–35 Hz at 75 Hz. Each bin's
+    energy is scaled back by the differencer's gain, so the band is flat
+    and rms_Pa is the pressure vibration itself.
+      expiration   block energy → noise floor (blower, sensor), slow EMA
+      inspiration  mean block energy / floor = vibration index of the breath
+    A breath snores when the index passes SNORE_RATIO_TH and the band RMS
+    SNORE_MIN_PA. Cost is one integer MAC per bin per sample; the cycles spent
+    are accumulated per breath for the status line.                       */
+
+constexpr uint8_t  SNORE_BLOCK       = 24;      // samples, 0.32 s at 75 Hz
+constexpr uint8_t  SNORE_BINS        = 7;       // contiguous, a tone on any bin is caught
+constexpr uint8_t  SNORE_BIN_K[SNORE_BINS] = { 5, 6, 7, 8, 9, 10, 11 };  // k / SNORE_BLOCK of fs
+constexpr uint16_t SNORE_MIN_ODR_HZ  = 50;      // below this the bins sit on breathing harmonics
+constexpr float    SNORE_FLOOR_ALPHA = 0.05f;   // per expiratory block
+constexpr float    SNORE_RATIO_TH    = 4.0f;
+constexpr float    SNORE_MIN_PA      = 1.0f;    // band RMS; LPS22 noise is ≤ 0.7 Pa in the band
+
+struct SnoreResult {
+  bool  valid;     // floor learned and at least one inspiratory block
+  bool  snore;
+  float index;     // inspiratory / expiratory band energy
+  float rms_Pa;    // inspiratory band RMS
+};
+
+struct SnoreStats {
+  float    avg_us;   // CPU per breath
+  uint32_t max_us;   // since snoreStatsReset()
+};
+
+void  snoreBegin();                     // after setupSensors(), reads the ODR
+void  snorePhase(bool insp);            // at each phase switch, blocks never straddle one
+void  snoreAdd(float pMask_hPa);        // every mask sample
+SnoreResult snoreInspDone();            // at the end of inspiration
+const SnoreStats& snoreGetStats();
+void  snoreStatsReset();
+
+#endif  // SNORE_H
@@ -0,0 +1,127 @@
+// span.cpp – implementation
+#include "span.h"
+
+struct SpanHist {
+  uint32_t n;
+  uint64_t sum;
+  uint32_t minC, maxC;
+  uint32_t bucket[SPAN_BUCKETS];
+  uint8_t  seen;          // resetReq this histogram was cleared for
+};
+
+static SpanHist hist[SPAN_COUNT];
+static volatile uint8_t resetReq = 0;
+
+static uint8_t bucketOf(uint32_t cyc) {
+  if (cyc < (1UL << (SPAN_MIN_LOG2 + 1))) return cyc < (3UL << (SPAN_MIN_LOG2 - 1)) ? 0 : 1;
+  const uint8_t msb = 31 - __builtin_clz(cyc);
+  const uint8_t b = 2 * (msb - SPAN_MIN_LOG2) + ((cyc >> (msb - 1)) & 1);
+  return b < SPAN_BUCKETS ? b : SPAN_BUCKETS - 1;
+}
+
+// cycles at the top of bucket b
+static uint32_t bucketTop(uint8_t b) {
+  const uint8_t o = SPAN_MIN_LOG2 + b / 2;
+  return (b & 1) ? (1UL << (o + 1)) : (3UL << (o - 1));
+}
+
+static bool live(const SpanHist& h) { return h.seen == resetReq && h.n; }
+
+static uint32_t cpuMhz() {
+  static const uint32_t mhz = max<uint32_t>(1, getCpuFrequencyMhz());
+  return mhz;
+}
+static uint32_t toUs(uint64_t cyc) { return (uint32_t)(cyc / cpuMhz()); }
+
+static uint32_t percentile(const SpanHist& h, float f) {
+  const uint32_t want = (uint32_t)ceilf(f * h.n);
+  uint32_t cum = 0;
+  for (uint8_t b = 0; b < SPAN_BUCKETS; ++b) {
+    cum += h.bucket[b];
+    if (cum >= want) return toUs(constrain(bucketTop(b), h.minC, h.maxC));
+  }
+  return toUs(h.maxC);
+}
+
+// ------------------------------------------------
+void spanEnd(SpanStage s, uint32_t c0) {
+  const uint32_t cyc = ESP.getCycleCount() - c0;
+  SpanHist& h = hist[s];
+  if (h.seen != resetReq) {
+    const uint8_t r = resetReq;
+    h = SpanHist{};
+    h.seen = r;
+  }
+  if (!h.n || cyc < h.minC) h.minC = cyc;
+  if (cyc > h.maxC) h.maxC = cyc;
+  h.n++;
+  h.sum += cyc;
+  h.bucket[bucketOf(cyc)]++;
+}
+
+const char* spanName(SpanStage s) {
+  switch (s) {
+    case SPAN_VIN:    return "vin";
+    case SPAN_HEALTH: return "health";
+    case SPAN_ACQ:    return "acq";
+    case SPAN_PAP:    return "pap";
+    case SPAN_CTL:    return "ctl";
+    case SPAN_UI:     return "ui";
+    case SPAN_BLE:    return "ble";
+    default:          return "?";
+  }
+}
+
+SpanStats spanGet(SpanStage s) {
+  SpanStats out{};
+  if (s >= SPAN_COUNT) return out;
+  const SpanHist& h = hist[s];
+  if (!live(h)) return out;
+  out.n      = h.n;
+  out.avg_us = (float)h.sum / h.n / cpuMhz();
+  out.min_us = toUs(h.minC);
+  out.max_us = toUs(h.maxC);
+  out.p50_us = percentile(h, 0.50f);
+  out.p90_us = percentile(h, 0.90f);
+  out.p99_us = percentile(h, 0.99f);
+  return out;
+}
+
+void spanReport() {
+  Serial.println("Spans: stage n avg min p50 p90 p99 max (us)");
+  for (uint8_t i = 0; i < SPAN_COUNT; ++i) {
+    const SpanStats s = spanGet((SpanStage)i);
+    Serial.printf("  %-6s %8lu %7.1f %5lu %5lu %5lu %5lu %6lu\n", spanName((SpanStage)i), (unsigned long)s.n,
+                  s.avg_us, (unsigned long)s.min_us, (unsigned long)s.p50_us, (unsigned long)s.p90_us,
+                  (unsigned long)s.p99_us, (unsigned long)s.max_us);
+  }
+}
+
+String spanCsv() {
+  String out;
+  out.reserve(1024);
+  out += "stage,n,avgUs,minUs,p50Us,p90Us,p99Us,maxUs";
+  for (uint8_t b = 0; b < SPAN_BUCKETS; ++b) {
+    char h[16];
+    snprintf(h, sizeof(h), ",lt%lu", (unsigned long)toUs(bucketTop(b)));
+    out += h;
+  }
+  out += "\n";
+  for (uint8_t i = 0; i < SPAN_COUNT; ++i) {
+    const SpanStats s = spanGet((SpanStage)i);
+    char line[384];
+    int n = snprintf(line, sizeof(line), "%s,%lu,%.1f,%lu,%lu,%lu,%lu,%lu", spanName((SpanStage)i),
+                     (unsigned long)s.n, s.avg_us, (unsigned long)s.min_us, (unsigned long)s.p50_us,
+                     (unsigned long)s.p90_us, (unsigned long)s.p99_us, (unsigned long)s.max_us);
+    const bool ok = live(hist[i]);
+    for (uint8_t b = 0; b < SPAN_BUCKETS && n < (int)sizeof(line); ++b)
+      n += snprintf(line + n, sizeof(line) - n, ",%lu", ok ? (unsigned long)hist[i].bucket[b] : 0UL);
+    out += line;
+    out += "\n";
+  }
+  return out;
+}
+
+void spanReset() {
+  resetReq = resetReq + 1;
+}
@@ -0,0 +1,47 @@
+// span.h – per‑stage latency histograms from the CPU cycle counter
+#ifndef SPAN_H
+#define SPAN_H
+
+#include <Arduino.h>
+
+/*  A span is two CCOUNT reads around a stage; spanEnd() bins the cycles
+    into half‑octave log buckets (SPAN_BUCKETS, from 2^8 cycles, ~1 µs at
+    240 MHz, up to ~70 ms; the ends are open) plus count, sum, min and
+    max. That is a handful of instructions, cheap enough to stay on in
+    production. CCOUNT is per core; the control task and loop() both run
+    on core 1. Percentiles are the bucket upper edges, so they are high by
+    at most one bucket (≤ 50 %); min/max are exact. Each stage has one
+    writer (its task); spanReset() only raises a flag that the writer
+    honours at its next span, so it is safe from the BLE task.            */
+
+enum SpanStage : uint8_t {
+  SPAN_VIN = 0,     // control: VIN monitor, stall kick
+  SPAN_HEALTH,      // control: sensor health
+  SPAN_ACQ,         // control: pressure batch, estimator, breath, overpressure check
+  SPAN_PAP,         // control: papLoop or motor off
+  SPAN_CTL,         // control: the whole step
+  SPAN_UI,          // loop(): runMainLogic()
+  SPAN_BLE,         // loop(): runBleStream()
+  SPAN_COUNT
+};
+
+constexpr uint8_t SPAN_BUCKETS   = 32;
+constexpr uint8_t SPAN_MIN_LOG2  = 8;   // bucket 0 holds everything below 2^(this+1) cycles
+
+struct SpanStats {
+  uint32_t n;
+  float    avg_us;
+  uint32_t min_us, max_us;
+  uint32_t p50_us, p90_us, p99_us;
+};
+
+inline uint32_t spanStart() { return ESP.getCycleCount(); }
+void spanEnd(SpanStage s, uint32_t c0);
+
+const char* spanName(SpanStage s);
+SpanStats   spanGet(SpanStage s);
+void        spanReport();              // one line per stage on Serial
+String      spanCsv();                 // stage, counts, µs stats, then the buckets
+void        spanReset();               // any task
+
+#endif  // SPAN_H
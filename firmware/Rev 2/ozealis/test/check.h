@@ -0,0 +1,33 @@
+// check.h – minimal assertions for the host tests
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+static int checkFailures = 0;
+
+#define CHECK(cond)                                                          \
+  do {                                                                       \
+    if (!(cond)) {                                                           \
+      printf("  FAIL %s:%d  %s\n", __FILE__, __LINE__, #cond);               \
+      checkFailures++;                                                       \
+    }                                                                        \
+  } while (0)
+
+// value within [lo, hi], printed with the bounds when it is not
+#define CHECK_RANGE(v, lo, hi)                                               \
+  do {                                                                       \
+    const double v_ = (v);                                                   \
+    if (!(v_ >= (lo) && v_ <= (hi))) {                                       \
+      printf("  FAIL %s:%d  %s = %g, want %g..%g\n", __FILE__, __LINE__, #v, \
+             v_, (double)(lo), (double)(hi));                                \
+      checkFailures++;                                                       \
+    }                                                                        \
+  } while (0)
+
+static int checkDone(const char* name) {
+  printf("%s: %s\n", name, checkFailures ? "FAILED" : "ok");
+  return checkFailures ? 1 : 0;
+}
+
+#endif  // CHECK_H
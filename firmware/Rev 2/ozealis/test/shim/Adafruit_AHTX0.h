@@ -0,0 +1,6 @@
+// Adafruit_AHTX0.h – host shim, type only
+#ifndef SHIM_ADAFRUIT_AHTX0_H
+#define SHIM_ADAFRUIT_AHTX0_H
+#include <Wire.h>
+class Adafruit_AHTX0 {};
+#endif
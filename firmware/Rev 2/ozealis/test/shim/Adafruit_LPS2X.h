@@ -0,0 +1,6 @@
+// Adafruit_LPS2X.h – host shim, type only
+#ifndef SHIM_ADAFRUIT_LPS2X_H
+#define SHIM_ADAFRUIT_LPS2X_H
+#include <Wire.h>
+class Adafruit_LPS22 {};
+#endif
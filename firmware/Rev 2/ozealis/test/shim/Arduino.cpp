@@ -0,0 +1,27 @@
+// Arduino.cpp – host shim globals
+#include "Arduino.h"
+#include <chrono>
+
+uint32_t shimMicros = 1000000;   // not zero, some modules treat 0 as "never"
+HardwareSerial Serial;
+EspClass ESP;
+
+static bool verbose() {
+  static const bool v = getenv("SHIM_VERBOSE") != nullptr;
+  return v;
+}
+
+size_t HardwareSerial::printf(const char* fmt, ...) {
+  if (!verbose()) return 0;
+  va_list ap;
+  va_start(ap, fmt);
+  const int n = vprintf(fmt, ap);
+  va_end(ap);
+  return n > 0 ? n : 0;
+}
+
+uint32_t EspClass::getCycleCount() {
+  using namespace std::chrono;
+  const auto ns = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+  return (uint32_t)(ns * 240 / 1000);
+}
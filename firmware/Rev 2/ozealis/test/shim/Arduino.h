@@ -0,0 +1,64 @@
+// Arduino.h – host shim, just enough of the ESP32 core for the pure C++ modules
+#ifndef SHIM_ARDUINO_H
+#define SHIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+using std::min;
+using std::max;
+
+#define IRAM_ATTR
+#define HIGH 1
+#define LOW  0
+#define PI   3.1415926535897932384626433832795
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// simulated clock, advanced by the tests; millis() follows micros()
+extern uint32_t shimMicros;
+inline unsigned long micros() { return shimMicros; }
+inline unsigned long millis() { return shimMicros / 1000; }
+inline void shimAdvanceUs(uint32_t us) { shimMicros += us; }
+inline void delay(uint32_t ms) { shimMicros += ms * 1000; }
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+
+class String {
+ public:
+  String(const char* s = "") : s_(s ? s : "") {}
+  String(float v, int d = 2) { char b[32]; snprintf(b, sizeof(b), "%.*f", d, v); s_ = b; }
+  const char* c_str() const { return s_.c_str(); }
+  size_t length() const { return s_.size(); }
+  void reserve(size_t n) { s_.reserve(n); }
+  String& operator+=(const char* s) { s_ += s; return *this; }
+  String& operator+=(const String& s) { s_ += s.s_; return *this; }
+ private:
+  std::string s_;
+};
+
+// Serial output is dropped unless SHIM_VERBOSE is set in the environment
+class HardwareSerial {
+ public:
+  void begin(unsigned long) {}
+  size_t print(const char* s) { return printf("%s", s); }
+  size_t println(const char* s = "") { return printf("%s\n", s); }
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+extern HardwareSerial Serial;
+
+// cycle counter emulated at 240 MHz from the host clock, for CPU cost figures
+struct EspClass {
+  uint32_t getCycleCount();
+};
+extern EspClass ESP;
+inline uint32_t getCpuFrequencyMhz() { return 240; }
+
+#endif  // SHIM_ARDUINO_H
@@ -0,0 +1,9 @@
+// NeoPixelBus.h – host shim, types only
+#ifndef SHIM_NEOPIXELBUS_H
+#define SHIM_NEOPIXELBUS_H
+
+struct NeoGrbFeature {};
+struct NeoEsp32Rmt0Ws2812xMethod {};
+template <typename F, typename M> class NeoPixelBus {};
+
+#endif  // SHIM_NEOPIXELBUS_H
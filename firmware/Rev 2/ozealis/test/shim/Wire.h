@@ -0,0 +1,7 @@
+// Wire.h – host shim, declarations only; nothing under test touches the bus
+#ifndef SHIM_WIRE_H
+#define SHIM_WIRE_H
+#include <Arduino.h>
+class TwoWire {};
+extern TwoWire Wire;
+#endif
@@ -0,0 +1,27 @@
+// esp_timer.h – host shim, declarations only; a test that links a module
+// using esp_timer simulates the timer itself
+#ifndef SHIM_ESP_TIMER_H
+#define SHIM_ESP_TIMER_H
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+#define ESP_OK                0
+#define ESP_ERR_INVALID_STATE 0x103
+
+typedef struct esp_timer* esp_timer_handle_t;
+typedef enum { ESP_TIMER_TASK = 0 } esp_timer_dispatch_t;
+typedef struct {
+  void (*callback)(void*);
+  void* arg;
+  esp_timer_dispatch_t dispatch_method;
+  const char* name;
+  bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+int64_t   esp_timer_get_time();
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out);
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t t);
+
+#endif  // SHIM_ESP_TIMER_H
@@ -0,0 +1,10 @@
+// FreeRTOS.h – host shim, the tests are single threaded
+#ifndef SHIM_FREERTOS_H
+#define SHIM_FREERTOS_H
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(m) ((void)(m))
+#define portEXIT_CRITICAL(m)  ((void)(m))
+
+#endif  // SHIM_FREERTOS_H
@@ -0,0 +1,36 @@
+// synth.h – synthetic breathing for the host tests
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <math.h>
+#include <random>
+
+// Sinusoidal breathing with known onsets: inspiration is a half sine of
+// peak_Lpm over ti_s, expiration a half sine sized so each breath nets zero
+// volume. Inspiration k starts at k·period_s.
+struct BreathSynth {
+  float period_s = 4.0f;
+  float ti_s     = 1.6f;
+  float peak_Lpm = 30.0f;
+
+  float te_s() const { return period_s - ti_s; }
+  float vt_mL() const { return peak_Lpm * ti_s * (2.0f / (float)M_PI) * (1000.0f / 60.0f); }
+  double onset_s(int k) const { return k * (double)period_s; }
+
+  float flow(double t) const {
+    const double tau = fmod(t, (double)period_s);
+    if (tau < ti_s) return peak_Lpm * (float)sin(M_PI * tau / ti_s);
+    return -peak_Lpm * (ti_s / te_s()) * (float)sin(M_PI * (tau - ti_s) / te_s());
+  }
+};
+
+// fixed seed, the same trace on every run
+struct Noise {
+  std::mt19937 rng{12345};
+  std::normal_distribution<float> n{0.0f, 1.0f};
+  float operator()(float sd) { return sd * n(rng); }
+};
+
+constexpr double SYNTH_FS_HZ = 75.0;   // LPS22 ODR in the firmware
+
+#endif  // SYNTH_H
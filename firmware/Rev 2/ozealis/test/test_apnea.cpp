@@ -0,0 +1,84 @@
+// test_apnea.cpp – apnea/hypopnea scoring on synthetic flow envelopes
+#include "check.h"
+#include "synth.h"
+#include "apnea.h"
+#include "cardio.h"
+
+uint16_t sensorSampleRateHz() { return (uint16_t)SYNTH_FS_HZ; }   // cardio.cpp
+
+// breath.cpp is replaced by the synthetic flow: the peak |flow| of the
+// samples since the last poll, as breathTakeAbsPeak_Lpm() reports it
+static BreathSynth synth;
+static Noise noise;
+static double simT = 0.0;
+static float  peakSince = NAN;
+float breathTakeAbsPeak_Lpm() {
+  const float p = peakSince;
+  peakSince = NAN;
+  return p;
+}
+
+// seconds of breathing at `scale` of the normal amplitude, polled every 50 ms
+static void breathe(double seconds, float scale, float noise_Lpm = 0.3f) {
+  const double end = simT + seconds;
+  const double dt = 1.0 / SYNTH_FS_HZ;
+  double nextPoll = simT;
+  for (; simT < end; simT += dt) {
+    const float q = fabsf(scale * synth.flow(simT) + noise(noise_Lpm));
+    if (!(q <= peakSince)) peakSince = q;
+    shimMicros = 1000000u + (uint32_t)(simT * 1e6);
+    if (simT >= nextPoll) {
+      apneaService(true);
+      nextPoll += 0.05;
+    }
+  }
+}
+
+static bool lastEvent(ApneaEvent& e) { return apneaSeq() && apneaGet(apneaSeq() - 1, e); }
+
+int main() {
+  cardioBegin();
+  apneaReset();
+  ApneaEvent e{};
+
+  // five minutes of regular breathing: reference learned, nothing scored
+  breathe(300, 1.0f);
+  CHECK(apneaSeq() == 0);
+
+  // 20 s of no flow, then recovery
+  breathe(20, 0.0f);
+  breathe(30, 1.0f);
+  CHECK(apneaSeq() == 1);
+  CHECK(lastEvent(e) && e.type == EVT_APNEA);
+  CHECK_RANGE(e.dur_s, 17, 24);
+  printf("  apnea 20 s      → type %u, %u s, min %u %%\n", e.type, e.dur_s, e.minPct);
+
+  // 30 s at half amplitude: a hypopnea, not an apnea
+  breathe(120, 1.0f);
+  breathe(30, 0.5f);
+  breathe(30, 1.0f);
+  CHECK(apneaSeq() == 2);
+  CHECK(lastEvent(e) && e.type == EVT_HYPOPNEA);
+  CHECK_RANGE(e.dur_s, 25, 38);
+  CHECK_RANGE(e.minPct, 40, 60);
+  printf("  hypopnea 30 s   → type %u, %u s, min %u %%\n", e.type, e.dur_s, e.minPct);
+
+  // a 20 % dip is normal variation
+  breathe(120, 1.0f);
+  breathe(30, 0.8f);
+  breathe(30, 1.0f);
+  CHECK(apneaSeq() == 2);
+
+  // reset in the middle of an apnea: the low run must not leak into the
+  // first event of the next session and turn a hypopnea into an apnea
+  breathe(15, 0.0f);
+  apneaReset();
+  breathe(180, 1.0f);
+  breathe(30, 0.5f);
+  breathe(30, 1.0f);
+  CHECK(apneaSeq() == 1);
+  CHECK(lastEvent(e) && e.type == EVT_HYPOPNEA);
+  printf("  after a reset   → type %u, %u s, min %u %%\n", e.type, e.dur_s, e.minPct);
+
+  return checkDone("apnea");
+}
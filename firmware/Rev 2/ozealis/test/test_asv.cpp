@@ -0,0 +1,128 @@
+// test_asv.cpp – minute ventilation, pressure support servo, periodic breathing
+#include "check.h"
+#include "synth.h"
+#include "asv.h"
+#include "breath.h"
+
+// breath.cpp is replaced by a ring of synthetic records, as breathSeq() /
+// breathGet() hand them out
+static BreathRecord ring[BREATH_RING];
+static uint32_t seq = 0;
+uint32_t breathSeq() { return seq; }
+bool breathGet(uint32_t s, BreathRecord& out) {
+  if (s >= seq || seq - s > BREATH_RING) return false;
+  out = ring[s % BREATH_RING];
+  return true;
+}
+
+static Noise noise;
+static double simT = 0.0;
+
+static void tick(double until) {
+  for (; simT < until; simT += 0.05) {   // asvUpdate() runs every papLoop, 50 ms is plenty
+    shimMicros = 1000000u + (uint32_t)(simT * 1e6);
+    asvUpdate();
+  }
+}
+
+// one breath of vt_mL over period_s, recorded when it ends
+static void breath(float vt_mL, float period_s = 4.0f) {
+  tick(simT + period_s);
+  BreathRecord r{};
+  r.ti_ms = (uint16_t)(period_s * 400.0f);
+  r.te_ms = (uint16_t)(period_s * 600.0f);
+  r.vt_mL = vt_mL;
+  ring[seq % BREATH_RING] = r;
+  seq++;
+}
+
+// seconds of regular breathing, Vt jittered by vtSd_mL
+static void breathe(double seconds, float vt_mL, float vtSd_mL = 0.0f) {
+  const double end = simT + seconds;
+  while (simT < end) breath(fmaxf(0.0f, vt_mL + noise(vtSd_mL)));
+}
+
+// Cheyne‑Stokes: Vt waxing and waning over cycle_s, a central apnea of
+// apnea_s at each trough
+static void cheyneStokes(double seconds, float cycle_s, float apnea_s, float vtPeak_mL) {
+  const double end = simT + seconds;
+  while (simT < end) {
+    const double ph = fmod(simT, (double)cycle_s);
+    if (ph < apnea_s) { tick(simT + apnea_s - ph); continue; }
+    const float x = (float)((ph - apnea_s) / (cycle_s - apnea_s));
+    breath(vtPeak_mL * sinf((float)M_PI * x) + 50.0f);
+  }
+}
+
+int main() {
+  asvReset(8.0f);
+
+  // 5 min of steady 500 mL at 15 bpm: 7.5 L/min. Ventilation is above
+  // the 90 % target, support walks down to the floor
+  breathe(300, 500.0f, 30.0f);
+  CHECK_RANGE(asvMV_Lpm(), 7.0, 8.0);
+  CHECK_RANGE(asvTarget_Lpm(), 0.9 * 7.0, 0.9 * 8.0);
+  CHECK_RANGE(asvPS_cm(), ASV_PS_MIN_CM, ASV_PS_MIN_CM + 0.01);
+  CHECK(!asvPeriodicBreathing());
+  printf("  steady 7.5 L/min   → MV %.2f, target %.2f, PS %.1f cm\n", asvMV_Lpm(), asvTarget_Lpm(), asvPS_cm());
+
+  // ventilation falls to 60 %: support rises, never more than the
+  // per‑breath step, and stays inside the bounds
+  const float target = asvTarget_Lpm();
+  float prev = asvPS_cm(), maxStep = 0.0f;
+  int toMax = -1;
+  for (int k = 0; k < 30; ++k) {
+    breath(300.0f);
+    maxStep = fmaxf(maxStep, fabsf(asvPS_cm() - prev));
+    prev = asvPS_cm();
+    if (toMax < 0 && asvPS_cm() >= ASV_PS_MAX_CM) toMax = k + 1;
+  }
+  CHECK(maxStep <= ASV_STEP_MAX_CM + 1e-4f);
+  CHECK_RANGE(asvPS_cm(), ASV_PS_MAX_CM - 0.01, ASV_PS_MAX_CM);
+  CHECK_RANGE(toMax, 12, 20);
+  // the target follows the 3 min window: 2 of its 3 minutes are now at 4.5
+  CHECK_RANGE(asvTarget_Lpm(), 0.9 * (7.5 + 2 * 4.5) / 3 - 0.3, 0.9 * (7.5 + 2 * 4.5) / 3 + 0.3);
+  CHECK(asvTarget_Lpm() < target);
+  printf("  drop to 4.5 L/min  → max step %.2f cm/breath, %d breaths to %.0f cm, target %.2f → %.2f\n", maxStep,
+         toMax, ASV_PS_MAX_CM, target, asvTarget_Lpm());
+
+  // back to normal: support comes down again
+  breathe(120, 500.0f);
+  CHECK(asvPS_cm() < ASV_PS_MAX_CM - 5.0f);
+  printf("  recovered          → PS %.1f cm\n", asvPS_cm());
+
+  // a silent bucket (central apnea) counts as a shortfall on its own
+  asvReset(5.0f);
+  breathe(120, 500.0f);
+  const float before = asvPS_cm();
+  tick(simT + 25.0);
+  CHECK(asvPS_cm() > before);
+  CHECK(asvRecentMV_Lpm() <= 7.5f * 0.75f + 0.2f);   // at least one whole silent bucket
+  printf("  25 s apnea         → PS %.1f → %.1f cm, recent MV %.2f L/min\n", before, asvPS_cm(), asvRecentMV_Lpm());
+
+  // regular breathing with 20 % breath‑to‑breath scatter is not periodic
+  asvReset(5.0f);
+  int falsePB = 0;
+  for (int i = 0; i < 60; ++i) {   // 10 min, checked every 10 s
+    breathe(10, 500.0f, 100.0f);
+    falsePB += asvPeriodicBreathing();
+  }
+  CHECK(falsePB == 0);
+  printf("  irregular 10 min   → periodic %d of 60 checks\n", falsePB);
+
+  // Cheyne‑Stokes, 60 s cycle with a 15 s apnea: found, period 60 s ± a bucket
+  asvReset(5.0f);
+  cheyneStokes(240, 60.0f, 15.0f, 900.0f);
+  CHECK(asvPeriodicBreathing());
+  CHECK_RANGE(asvCycle_s(), 50, 70);
+  printf("  Cheyne-Stokes 60 s → periodic %d, cycle %.0f s\n", asvPeriodicBreathing(), asvCycle_s());
+
+  // and a 45 s cycle
+  asvReset(5.0f);
+  cheyneStokes(240, 45.0f, 10.0f, 900.0f);
+  CHECK(asvPeriodicBreathing());
+  CHECK_RANGE(asvCycle_s(), 40, 50);
+  printf("  Cheyne-Stokes 45 s → periodic %d, cycle %.0f s\n", asvPeriodicBreathing(), asvCycle_s());
+
+  return checkDone("asv");
+}
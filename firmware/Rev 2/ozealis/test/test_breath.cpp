@@ -0,0 +1,109 @@
+// test_breath.cpp – breath segmentation on synthetic breathing with a vent leak
+#include "check.h"
+#include "synth.h"
+#include "breath.h"
+#include "leak.h"
+#include "cardio.h"
+#include "snore.h"
+
+// flow is handed through as the pressure difference, L/min
+float flowFromDiff_Lpm(float d) { return d; }
+float hPa_to_cmH2O(float hPa) { return hPa * 1.019716f; }
+uint16_t sensorSampleRateHz() { return (uint16_t)SYNTH_FS_HZ; }
+
+static constexpr float AMBIENT_HPA = 1013.25f;
+static constexpr float MASK_CM = 10.0f;
+
+struct Result {
+  int   breaths;
+  float onsetErrMax_ms, tiErrMax_ms, teErrMax_ms, vtErrMax_pct, latAvg_ms, latMax_ms;
+};
+
+// nBreaths of breathing at fs, in batches like the control task drains
+static Result run(const BreathSynth& b, int nBreaths, float noise_Lpm) {
+  breathBegin();
+  snoreBegin();
+  cardioBegin();
+  Noise noise;
+  const float pm = MASK_CM / 1.019716f;
+  const float leak = LEAK_VENT_K * sqrtf(MASK_CM);
+  const uint32_t t0 = micros();
+
+  Result r{};
+  float latSum = 0.0f;
+  uint32_t seen = 0;
+  BreathRecord rec;
+
+  // the first breaths are skipped, the leak and threshold are still settling
+  auto collect = [&]() {
+    for (; seen < breathSeq(); ++seen) {
+      if (!breathGet(seen, rec)) continue;
+      const double on = (rec.inspOnset_us - t0) * 1e-6;
+      const int kb = (int)lround(on / b.period_s);
+      if (kb < 5) continue;
+      r.breaths++;
+      r.onsetErrMax_ms = max(r.onsetErrMax_ms, (float)fabs(on - b.onset_s(kb)) * 1000.0f);
+      r.tiErrMax_ms = max(r.tiErrMax_ms, fabsf(rec.ti_ms - b.ti_s * 1000.0f));
+      r.teErrMax_ms = max(r.teErrMax_ms, fabsf(rec.te_ms - b.te_s() * 1000.0f));
+      r.vtErrMax_pct = max(r.vtErrMax_pct, 100.0f * fabsf(rec.vt_mL - b.vt_mL()) / b.vt_mL());
+      r.latMax_ms = max(r.latMax_ms, (float)rec.detLat_ms);
+      latSum += rec.detLat_ms;
+    }
+  };
+
+  const int n = (int)(nBreaths * b.period_s * SYNTH_FS_HZ);
+  PressureSample batch[3];
+  uint8_t k = 0;
+  for (int i = 0; i < n; ++i) {
+    const double t = i / SYNTH_FS_HZ;
+    PressureSample& s = batch[k++];
+    s.t_us = t0 + (uint32_t)(t * 1e6);
+    s.pMask_hPa = AMBIENT_HPA + pm;
+    s.pBlower_hPa = s.pMask_hPa + b.flow(t) + leak + noise(noise_Lpm);
+    if (k == 3) {
+      shimMicros = s.t_us;
+      breathTrack(batch, k, AMBIENT_HPA);
+      collect();
+      k = 0;
+    }
+  }
+  r.latAvg_ms = r.breaths ? latSum / r.breaths : 0.0f;
+  return r;
+}
+
+static void report(const char* name, const Result& r) {
+  printf("  %-22s breaths %3d  onset err max %5.0f ms  Ti/Te err max %4.0f/%4.0f ms  Vt err max %4.1f %%  "
+         "detection latency avg %4.0f max %4.0f ms\n",
+         name, r.breaths, r.onsetErrMax_ms, r.tiErrMax_ms, r.teErrMax_ms, r.vtErrMax_pct, r.latAvg_ms, r.latMax_ms);
+}
+
+int main() {
+  BreathSynth adult;                       // 15 bpm, 30 L/min peak
+  const Result clean = run(adult, 60, 0.0f);
+  report("15 bpm clean", clean);
+  CHECK(clean.breaths >= 54 && clean.breaths <= 55);
+  CHECK_RANGE(clean.onsetErrMax_ms, 0, 30);
+  CHECK_RANGE(clean.tiErrMax_ms, 0, 40);
+  CHECK_RANGE(clean.teErrMax_ms, 0, 40);
+  CHECK_RANGE(clean.vtErrMax_pct, 0, 5);
+  CHECK_RANGE(clean.latMax_ms, 0, 250);
+
+  const Result noisy = run(adult, 60, 1.0f);
+  report("15 bpm, 1 L/min noise", noisy);
+  CHECK(noisy.breaths >= 54 && noisy.breaths <= 55);
+  CHECK_RANGE(noisy.onsetErrMax_ms, 0, 80);
+  CHECK_RANGE(noisy.tiErrMax_ms, 0, 120);
+  CHECK_RANGE(noisy.vtErrMax_pct, 0, 10);
+  CHECK_RANGE(noisy.latMax_ms, 0, 250);
+
+  BreathSynth fast;                        // 30 bpm, shallow
+  fast.period_s = 2.0f;
+  fast.ti_s = 0.8f;
+  fast.peak_Lpm = 20.0f;
+  const Result quick = run(fast, 120, 0.5f);
+  report("30 bpm, 0.5 L/min noise", quick);
+  CHECK(quick.breaths >= 114 && quick.breaths <= 115);
+  CHECK_RANGE(quick.tiErrMax_ms, 0, 60);
+
+  return checkDone("breath");
+}
@@ -0,0 +1,87 @@
+// test_cardio.cpp – cardiogenic ripple vs noise in quiet apnea stretches
+#include "check.h"
+#include "synth.h"
+#include "cardio.h"
+
+uint16_t sensorSampleRateHz() { return (uint16_t)SYNTH_FS_HZ; }   // cardio.cpp
+
+constexpr float NOISE_LPM = 0.8f;   // flow noise at 75 Hz, sensor + √ΔP law near zero
+constexpr int   TRIALS    = 20;
+
+static Noise noise;
+static double simT = 0.0;
+
+// `seconds` of flow at 75 Hz, the 1 s apnea blocks marked quiet or not
+static void flow(double seconds, float ripple_Lpm, float hr_Hz, bool quiet) {
+  const double dt = 1.0 / SYNTH_FS_HZ;
+  const double end = simT + seconds;
+  double nextBlock = simT + 1.0;
+  for (; simT < end; simT += dt) {
+    cardioAdd(ripple_Lpm * sinf(2.0f * (float)M_PI * hr_Hz * (float)simT) + noise(NOISE_LPM));
+    if (simT >= nextBlock) {
+      cardioBlock(quiet);
+      nextBlock += 1.0;
+    }
+  }
+}
+
+// one 12 s central apnea between breathing, as apnea.cpp drives it
+static CardioResult apnea(float ripple_Lpm, float hr_Hz) {
+  flow(3, 0.0f, hr_Hz, false);
+  flow(12, ripple_Lpm, hr_Hz, true);
+  cardioBlock(false);
+  return cardioTake();
+}
+
+int main() {
+  cardioBegin();
+  flow(5, 0.0f, 1.0f, false);
+
+  // noise only: the peak autocorrelation in the heart rate lags
+  float rMax = 0.0f, rSum = 0.0f;
+  int falseOsc = 0;
+  for (int i = 0; i < 10 * TRIALS; ++i) {
+    const CardioResult c = apnea(0.0f, 1.0f);
+    CHECK(c.valid);
+    rMax = fmaxf(rMax, c.r);
+    rSum += c.r;
+    falseOsc += c.oscillating;
+  }
+  CHECK(falseOsc == 0);
+  CHECK(rMax < CARDIO_R_TH);
+  printf("  noise only, %d stretches: r avg %.2f max %.2f, %d oscillating\n", 10 * TRIALS, rSum / (10 * TRIALS), rMax,
+         falseOsc);
+
+  // ripple amplitude × heart rate, TRIALS stretches each
+  printf("  ripple L/min  HR Hz:  r min..max, detected, HR error max\n");
+  const float amps[] = { 0.3f, 0.6f, 1.0f };
+  const float hrs[]  = { 0.8f, 1.2f, 1.6f, 2.2f };
+  for (float a : amps) {
+    for (float f : hrs) {
+      float lo = 1.0f, hi = 0.0f, hrErr = 0.0f;
+      int hits = 0;
+      for (int i = 0; i < TRIALS; ++i) {
+        const CardioResult c = apnea(a, f);
+        lo = fminf(lo, c.r);
+        hi = fmaxf(hi, c.r);
+        if (c.oscillating) {
+          hits++;
+          hrErr = fmaxf(hrErr, fabsf(c.hr_bpm - 60.0f * f) / (60.0f * f));
+        }
+      }
+      printf("  %5.1f         %3.1f:   %.2f..%.2f, %2d/%d, %4.1f %%\n", a, f, lo, hi, hits, TRIALS, hrErr * 100);
+      if (a >= 0.6f) {
+        CHECK(hits == TRIALS);
+        CHECK(hrErr < 0.10f);   // a lag step at 15 Hz is ~7 % at 2.2 Hz
+      }
+    }
+  }
+
+  // a stretch shorter than CARDIO_MIN_S is not classified
+  flow(3, 0.0f, 1.0f, false);
+  flow(6, 1.0f, 1.2f, true);
+  cardioBlock(false);
+  CHECK(!cardioTake().valid);
+
+  return checkDone("cardio");
+}
@@ -0,0 +1,91 @@
+// test_pressctl.cpp – PI pressure loop against a blower/mask plant model
+#include "check.h"
+#include "synth.h"
+#include "pressctl.h"
+
+// Blower + hose: static pressure gain off the nominal feed-forward map by
+// GAIN_ERR, first-order motor lag, and a drop proportional to patient flow
+// through the hose. The measurement carries sensor noise.
+struct Plant {
+  float gain_cm_per_count = 0.85f / PCTL_FF_PER_CM;   // 15 % weaker than the map assumes
+  float tau_s = 0.08f;
+  float r_cm_per_Lpm = 0.05f;
+  float p = 0.0f;                                      // blower outlet, cm
+  float step(uint8_t u, float q_Lpm, float dt) {
+    p += (u * gain_cm_per_count - p) * (dt / tau_s);
+    return p - r_cm_per_Lpm * q_Lpm;                   // mask pressure
+  }
+};
+
+struct Run {
+  float rise90_ms, overshoot_cm, ssErr_cm, breathRms_cm;
+};
+
+// closed: PI on the noisy measurement; open: feed-forward only, as before
+static Run run(bool closed) {
+  constexpr float DT = 0.005f;   // 200 Hz control task
+  Plant plant;
+  BreathSynth breath;
+  Noise noise;
+  pctlSetFeedForward(true);
+  pctlReset(4.0f);
+  plant.p = 4.0f * plant.gain_cm_per_count * PCTL_FF_PER_CM;
+
+  Run r{};
+  float mask = plant.p, target = 4.0f;
+  double sq = 0.0;
+  int nSq = 0;
+  bool rose = false;
+  for (int i = 0; i < (int)(40.0f / DT); ++i) {
+    const float t = i * DT;
+    if (t >= 2.0f) target = 10.0f;                      // step at 2 s, no breathing yet
+    const float q = t >= 10.0f ? breath.flow(t) : 0.0f;  // breathing from 10 s
+    const float meas = mask + noise(0.05f);
+    const uint8_t u = closed ? pctlUpdate(target, meas, DT) : pctlFeedForward(target);
+    mask = plant.step(u, q, DT);
+
+    if (t >= 2.0f && t < 10.0f) {
+      if (!rose && mask >= 4.0f + 0.9f * 6.0f) { rose = true; r.rise90_ms = (t - 2.0f) * 1000.0f; }
+      r.overshoot_cm = max(r.overshoot_cm, mask - 10.0f);
+    }
+    if (t >= 9.0f && t < 10.0f) r.ssErr_cm = max(r.ssErr_cm, fabsf(mask - 10.0f));
+    if (t >= 20.0f) { sq += (mask - 10.0f) * (mask - 10.0f); nSq++; }
+  }
+  if (!rose) r.rise90_ms = 99999.0f;
+  r.breathRms_cm = sqrtf(sq / nSq);
+  return r;
+}
+
+static void report(const char* name, const Run& r) {
+  printf("  %-12s 4→10 cm rise90 %5.0f ms  overshoot %4.2f cm  steady err %4.2f cm  "
+         "deviation while breathing %4.2f cm rms\n",
+         name, r.rise90_ms, r.overshoot_cm, r.ssErr_cm, r.breathRms_cm);
+}
+
+int main() {
+  const Run open = run(false);
+  const Run pi = run(true);
+  report("open loop", open);
+  report("PI", pi);
+
+  CHECK_RANGE(pi.ssErr_cm, 0, 0.25);
+  CHECK_RANGE(pi.overshoot_cm, -1, 0.5);
+  CHECK_RANGE(pi.rise90_ms, 0, 400);
+  CHECK(pi.breathRms_cm < 0.6f * open.breathRms_cm);
+  CHECK(open.ssErr_cm > 1.0f);   // the plant really is off the map
+
+  // no measurement: feed-forward plus the held integrator, no wind-up
+  pctlReset(10.0f);
+  for (int i = 0; i < 400; ++i) pctlUpdate(10.0f, NAN, 0.005f);
+  CHECK(pctlIntegral() == 0.0f);
+  CHECK(pctlUpdate(10.0f, NAN, 0.005f) == pctlFeedForward(10.0f));
+
+  // rail: with the output saturated the integrator stops, it does not run
+  // to its bound while the target is out of reach
+  pctlReset(0.0f);
+  for (int i = 0; i < 2000; ++i) pctlUpdate(30.0f, 0.0f, 0.005f);
+  printf("  saturated 10 s → integrator %.1f counts (bound %.0f)\n", pctlIntegral(), PCTL_I_MAX);
+  CHECK(pctlIntegral() < 0.5f * PCTL_I_MAX);
+
+  return checkDone("pressctl");
+}
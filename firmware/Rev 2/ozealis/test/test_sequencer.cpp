@@ -0,0 +1,214 @@
+// test_sequencer.cpp – pattern timing, priorities and the timer restart race
+#include "check.h"
+#include "sequencer.h"
+#include <esp_timer.h>
+#include <chrono>
+#include <functional>
+
+// One esp_timer, run off the shim clock. start_once on an armed timer
+// fails with ESP_ERR_INVALID_STATE, as on the ESP32.
+static void (*timerCb)(void*) = nullptr;
+static bool     armed = false, inCb = false;
+static uint32_t dueAt = 0;
+static std::function<void()> racer;   // runs inside the callback's next start_once
+static bool     deferStart = false;   // the racer's own start lands after the callback's
+static uint64_t deferredUs = 0;
+static bool     hasDeferred = false;
+static int      startFailures = 0;
+
+int64_t esp_timer_get_time() { return shimMicros; }
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+  timerCb = args->callback;
+  *out = (esp_timer_handle_t)1;
+  return ESP_OK;
+}
+esp_err_t esp_timer_stop(esp_timer_handle_t) {
+  if (!armed) return ESP_ERR_INVALID_STATE;
+  armed = false;
+  return ESP_OK;
+}
+static esp_err_t arm(uint64_t us) {
+  if (armed) {
+    startFailures++;
+    return ESP_ERR_INVALID_STATE;
+  }
+  armed = true;
+  dueAt = shimMicros + (uint32_t)us;
+  return ESP_OK;
+}
+esp_err_t esp_timer_start_once(esp_timer_handle_t, uint64_t us) {
+  if (deferStart) {
+    deferredUs = us;
+    hasDeferred = true;
+    return ESP_OK;
+  }
+  if (inCb && racer) {
+    // another task's seqPlay() gets in between the callback's read of the
+    // step and its restart: its stop runs first, its start after ours
+    auto r = racer;
+    racer = nullptr;
+    deferStart = true;
+    r();
+    deferStart = false;
+    const esp_err_t e = arm(us);
+    if (hasDeferred) {
+      hasDeferred = false;
+      arm(deferredUs);
+    }
+    return e;
+  }
+  return arm(us);
+}
+
+// buzzer.cpp / led.cpp: record the edges
+struct Edge { uint32_t t_us; bool on; };
+static Edge     buzEdges[256];
+static int      nBuz = 0;
+static bool     buz = false, overlayOn = false;
+static uint32_t overlayRgb = 0;
+static std::function<void()> onBuzzer;   // runs inside the next buzzerSet()
+void buzzerSet(bool on) {
+  if (on != buz && nBuz < 256) buzEdges[nBuz++] = { shimMicros, on };
+  buz = on;
+  if (onBuzzer) {
+    auto f = onBuzzer;
+    onBuzzer = nullptr;
+    f();
+  }
+}
+void ledOverlay(bool on, uint32_t rgb) {
+  overlayOn = on;
+  overlayRgb = rgb;
+}
+
+// fire the timer as the clock passes its due time
+static void runUntil(uint32_t t) {
+  while (armed && dueAt <= t) {
+    shimMicros = dueAt;
+    armed = false;
+    inCb = true;
+    timerCb(nullptr);
+    inCb = false;
+  }
+  shimMicros = t;
+}
+static void runMs(uint32_t ms) { runUntil(shimMicros + ms * 1000); }
+static void settle() {
+  runMs(5000);
+  nBuz = 0;
+}
+
+// on‑times and off‑times of the beeps recorded since the last settle()
+static int beeps(uint32_t* onMs, uint32_t* offMs) {
+  int n = 0;
+  for (int i = 0; i + 1 < nBuz; i += 2) {
+    onMs[n] = (buzEdges[i + 1].t_us - buzEdges[i].t_us) / 1000;
+    offMs[n] = i + 2 < nBuz ? (buzEdges[i + 2].t_us - buzEdges[i + 1].t_us) / 1000 : 0;
+    n++;
+  }
+  return n;
+}
+
+int main() {
+  shimMicros = 1000000;
+  seqBegin();
+
+  // overpressure: 5 × 80/120 ms, and seqPlay() costs the caller nothing
+  // on the simulated clock; the old alarmBeep(5) held it for 5 × 200 ms
+  const uint32_t t0 = shimMicros;
+  CHECK(seqPlay(SEQ_FAULT_OVERP));
+  CHECK(shimMicros == t0);
+  runMs(2000);
+  uint32_t on[64], off[64];
+  int n = beeps(on, off);
+  CHECK(n == 5);
+  for (int i = 0; i < n; ++i) {
+    CHECK(on[i] == 80);
+    if (i < n - 1) CHECK(off[i] == 120);
+  }
+  CHECK(!seqBusy() && !buz);
+  // host cost of a post, averaged over replacing posts
+  const auto h0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < 1000; ++i) seqPlay(SEQ_FAULT_OVERP);
+  const auto h1 = std::chrono::steady_clock::now();
+  printf("  SEQ_FAULT_OVERP: %d beeps %u/%u ms; caller stall 0 ms simulated (alarmBeep(5) was %u ms), "
+         "%lld ns/post host\n",
+         n, on[0], off[0], 5u * (80 + 120),
+         (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(h1 - h0).count() / 1000);
+  settle();
+
+  // a lower priority is dropped, an equal or higher one replaces
+  CHECK(seqPlay(SEQ_FAULT_OVERP));
+  runMs(10);
+  CHECK(!seqPlay(SEQ_NOTICE_BEEP));
+  CHECK(seqPlay(SEQ_FAULT_VIN));
+  runMs(2000);
+  n = beeps(on, off);
+  CHECK(n == 2);
+  settle();
+
+  // a pattern without LEDs replacing one with them hands the LEDs back
+  CHECK(seqPlay(SEQ_ERASE));
+  runMs(10);
+  CHECK(overlayOn && overlayRgb == 0xFF0000);
+  CHECK(seqPlay(SEQ_FAULT_OTHER));
+  runMs(10);
+  CHECK(!overlayOn);
+  settle();
+
+  // a stray timer fire in the middle of a step does not cut it short
+  CHECK(seqPlay(SEQ_FAULT_VIN));
+  runMs(40);
+  inCb = true;
+  timerCb(nullptr);
+  inCb = false;
+  runMs(2000);
+  n = beeps(on, off);
+  CHECK(n == 2 && on[0] == 80 && off[0] == 120);
+  settle();
+
+  // the restart race: a fault posted from the control task while the
+  // callback is between reading its step and restarting the timer. The
+  // new pattern must start at once, not one step later
+  int worst = 0;
+  const int startFailures0 = startFailures;
+  for (int k = 0; k < 10; ++k) {
+    CHECK(seqPlay(SEQ_ERASE));
+    runMs(75 * k);
+    uint32_t posted = 0;
+    racer = [&] {
+      posted = shimMicros;
+      seqPlay(SEQ_FAULT_OTHER);
+    };
+    runMs(1000);
+    int first = -1;
+    for (int i = 0; i < nBuz; ++i)
+      if (buzEdges[i].on && buzEdges[i].t_us >= posted) {
+        first = (int)(buzEdges[i].t_us - posted) / 1000;
+        break;
+      }
+    CHECK(first == 0);
+    worst = max(worst, first < 0 ? 1000 : first);
+    n = beeps(on, off);
+    CHECK(n == 1 && on[0] == 80);
+    settle();
+  }
+  printf("  restart race, 10 posts: new pattern starts ≤ %d ms late, %d lost starts\n", worst,
+         startFailures - startFailures0);
+
+  // a seqPlay() from inside the step's own output (another task preempting
+  // the callback right after its lock) is picked up the same way
+  CHECK(seqPlay(SEQ_FAULT_VIN));
+  uint32_t posted = 0;
+  onBuzzer = [&] {
+    posted = shimMicros;
+    seqPlay(SEQ_FAULT_OVERP);
+  };
+  runMs(2000);
+  n = beeps(on, off);
+  CHECK(n == 5);
+  CHECK(buzEdges[nBuz - 1].t_us - posted <= 5 * 200000);
+  settle();
+
+  return checkDone("sequencer");
+}
@@ -0,0 +1,113 @@
+// test_snore.cpp – Goertzel bins against synthetic inspiratory tones
+#include "check.h"
+#include "synth.h"
+#include "snore.h"
+
+uint16_t sensorSampleRateHz() { return (uint16_t)SYNTH_FS_HZ; }   // snore.cpp
+
+constexpr float LPS_NOISE_HPA = 0.0075f;   // LPS22 rms noise at its low‑noise setting
+constexpr float LPS_LSB_HPA   = 1.0f / 4096.0f;
+
+static Noise noise;
+static double simT = 0.0;
+static long samples = 0;
+
+// mask pressure: 10 cmH2O, ±0.5 hPa breathing swing (inspiration pulls it
+// down), sensor noise, quantised to the LPS22 LSB
+static float maskP(double t, bool insp, float phase01) {
+  const float swing = insp ? -0.5f * sinf((float)M_PI * phase01) : 0.3f * sinf((float)M_PI * phase01);
+  (void)t;
+  return roundf((9.81f + swing + noise(LPS_NOISE_HPA)) / LPS_LSB_HPA) * LPS_LSB_HPA;
+}
+
+// one 4 s breath; a tone of amp_Pa at tone_Hz rides on inspiration only
+static SnoreResult breath(float tone_Hz, float amp_Pa, float expAmp_Pa = 0.0f) {
+  const double dt = 1.0 / SYNTH_FS_HZ, ti = 1.6, te = 2.4;
+  snorePhase(false);
+  for (double t = 0.0; t < te; t += dt, simT += dt, ++samples) {
+    const float hum = expAmp_Pa * 0.01f * sinf(2.0f * (float)M_PI * tone_Hz * (float)simT);
+    snoreAdd(maskP(simT, false, (float)(t / te)) + hum);
+  }
+  snorePhase(true);
+  for (double t = 0.0; t < ti; t += dt, simT += dt, ++samples) {
+    const float tone = amp_Pa * 0.01f * sinf(2.0f * (float)M_PI * tone_Hz * (float)simT);
+    snoreAdd(maskP(simT, true, (float)(t / ti)) + tone);
+  }
+  return snoreInspDone();
+}
+
+// average of n breaths after the floor has settled
+static SnoreResult train(float tone_Hz, float amp_Pa, int n = 8) {
+  SnoreResult avg{};
+  int snores = 0;
+  for (int i = 0; i < n; ++i) {
+    const SnoreResult r = breath(tone_Hz, amp_Pa);
+    avg.valid = r.valid;
+    avg.index += r.index / n;
+    avg.rms_Pa += r.rms_Pa / n;
+    snores += r.snore;
+  }
+  avg.snore = snores == n;
+  return avg;
+}
+
+int main() {
+  snoreBegin();
+
+  for (int i = 0; i < 20; ++i) breath(0, 0);
+
+  // noise only: breathing swing + sensor noise never scores
+  int falseSnores = 0;
+  float maxIdx = 0.0f, maxRms = 0.0f;
+  for (int i = 0; i < 200; ++i) {
+    const SnoreResult r = breath(0, 0);
+    CHECK(r.valid);
+    falseSnores += r.snore;
+    maxIdx = fmaxf(maxIdx, r.index);
+    maxRms = fmaxf(maxRms, r.rms_Pa);
+  }
+  CHECK(falseSnores == 0);
+  CHECK(maxIdx < SNORE_RATIO_TH);
+  printf("  noise only, 200 breaths: %d snores, index ≤ %.2f, band rms ≤ %.2f Pa\n", falseSnores, maxIdx, maxRms);
+
+  // tones across the band: index and band rms per amplitude
+  printf("  tone Hz   amp Pa:  index / band rms Pa\n");
+  const float freqs[] = { 15, 20, 25, 30, 35 };
+  const float amps[]  = { 0.5f, 1.0f, 2.0f, 4.0f };
+  for (float f : freqs) {
+    printf("  %5.0f   ", f);
+    for (float a : amps) {
+      const SnoreResult r = train(f, a);
+      printf("  %4.1f: %5.1f / %4.2f%s", a, r.index, r.rms_Pa, r.snore ? "*" : " ");
+      if (a >= 2.0f) CHECK(r.snore);            // a 2 Pa vibration anywhere in 15–35 Hz
+      if (a <= 1.0f) CHECK(!r.snore);           // within 3x of the noise energy
+      if (a == 4.0f) CHECK_RANGE(r.rms_Pa, 0.8 * 4.0 / M_SQRT2, 1.2 * 4.0 / M_SQRT2);   // flat across the band
+    }
+    printf("\n");
+    for (int i = 0; i < 10; ++i) breath(0, 0);  // let the floor settle back
+  }
+
+  // a steady hum in both phases (blower tone) is learned as floor, not snoring
+  for (int i = 0; i < 60; ++i) breath(25, 3.0f, 3.0f);
+  const SnoreResult hum = breath(25, 3.0f, 3.0f);
+  CHECK(!hum.snore);
+  CHECK(hum.index < SNORE_RATIO_TH);
+  printf("  3 Pa hum in both phases: index %.2f, snore %d\n", hum.index, hum.snore);
+
+  // below the band: a 5 Hz tremor is breathing harmonics territory, not scored
+  for (int i = 0; i < 10; ++i) breath(0, 0);
+  const SnoreResult low = train(5, 4.0f);
+  CHECK(!low.snore);
+  printf("  5 Hz, 4 Pa: index %.2f\n", low.index);
+
+  // CPU per breath through the same SnoreStats the status line shows. The
+  // shim's cycle counter runs off the host clock at 240 MHz, so this is the
+  // host's time, not the ESP32's; the work per sample is fixed
+  snoreStatsReset();
+  const long s0 = samples;
+  for (int i = 0; i < 1000; ++i) breath(25, 2.0f);
+  printf("  %ld samples/breath, %u bins; host avg %.1f us/breath, max %u us\n", (samples - s0) / 1000, SNORE_BINS,
+         snoreGetStats().avg_us, snoreGetStats().max_us);
+
+  return checkDone("snore");
+}
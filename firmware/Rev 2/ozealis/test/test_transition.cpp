@@ -0,0 +1,100 @@
+// test_transition.cpp – shaped IPAP/EPAP set‑point vs a plain step
+#include "check.h"
+#include "transition.h"
+
+constexpr double CTL_HZ   = 200.0;   // control task rate
+constexpr double PLANT_TAU = 0.08;   // blower + hose lag, s (test_pressctl)
+
+struct Shaping {
+  double maxSlope;      // |dP/dt| of the set‑point, cm/s
+  double maxAccel;      // |d²P/dt²|, cm/s²
+  double settle_ms;     // step edge → set‑point within 0.1 cm of the target
+  double followRms;     // rms(set‑point − pressure) of a τ‑lag plant: what the loop must absorb
+  double followPeak;
+  double trackRms;      // rms(target − pressure): the delivered pressure vs the discrete target
+};
+
+// 10 BiPAP breaths, EPAP 6 / IPAP 12 at 4 s, Ti 1.6 s
+static Shaping run() {
+  Shaping r{};
+  const double dt = 1.0 / CTL_HZ;
+  const long period = lround(4.0 * CTL_HZ), ti = lround(1.6 * CTL_HZ), n = 10 * period;
+  double prevSp = 6.0, prevSlope = 0.0, p = 6.0, sf = 0.0, st = 0.0;
+  long lastEdge = 0;
+  transReset(6.0f);
+  for (long k = 0; k < n; ++k) {
+    const long ph = k % period;
+    const float target = ph < ti ? 12.0f : 6.0f;
+    if (ph == 0 || ph == ti) lastEdge = k;
+    shimMicros = 1000000u + (uint32_t)(k * dt * 1e6);
+    const double sp = transUpdate(target);
+
+    const double slope = (sp - prevSp) / dt;
+    if (k > 0) {
+      r.maxSlope = fmax(r.maxSlope, fabs(slope));
+      r.maxAccel = fmax(r.maxAccel, fabs(slope - prevSlope) / dt);
+    }
+    if (fabs(sp - target) > 0.1) r.settle_ms = fmax(r.settle_ms, (k - lastEdge + 1) * dt * 1000.0);
+    prevSlope = slope;
+    prevSp = sp;
+
+    p += (sp - p) * dt / PLANT_TAU;
+    sf += (sp - p) * (sp - p);
+    st += (target - p) * (target - p);
+    r.followPeak = fmax(r.followPeak, fabs(sp - p));
+  }
+  r.followRms = sqrt(sf / n);
+  r.trackRms = sqrt(st / n);
+  return r;
+}
+
+static void show(const char* name, const Shaping& s) {
+  printf("  %-7s slope %5.0f cm/s  accel %6.0f cm/s²  settle %3.0f ms  follow %.2f rms %.2f peak  track %.2f rms\n",
+         name, s.maxSlope, s.maxAccel, s.settle_ms, s.followRms, s.followPeak, s.trackRms);
+}
+
+int main() {
+  // the old behaviour: the set‑point jumps
+  transConfigure(0, 0, TRANS_COSINE);
+  const Shaping step = run();
+  show("step", step);
+  CHECK_RANGE(step.maxSlope, 6.0 * CTL_HZ - 1, 6.0 * CTL_HZ + 1);   // the whole 6 cm in one tick
+  CHECK_RANGE(step.followPeak, 5.0, 6.0);
+
+  const char* names[] = { "cosine", "exp", "linear" };
+  for (uint8_t s = TRANS_COSINE; s <= TRANS_LINEAR; ++s) {
+    transConfigure(300, 400, (TransShape)s);
+    const Shaping r = run();
+    show(names[s], r);
+    CHECK(r.maxSlope < step.maxSlope / 10);
+    CHECK(r.maxAccel < step.maxAccel / 10);
+    CHECK(r.followPeak < step.followPeak / 2);
+    CHECK(r.followRms < step.followRms);
+    CHECK(r.trackRms < step.trackRms * 2.5);   // the price: the shaped edge arrives later
+    CHECK_RANGE(r.settle_ms, 200, 405);        // inside the fall time, not longer
+  }
+  // the raised cosine starts and ends at zero slope: the gentlest second derivative
+  transConfigure(300, 400, TRANS_COSINE);
+  const Shaping cosine = run();
+  transConfigure(300, 400, TRANS_LINEAR);
+  CHECK(cosine.maxAccel < run().maxAccel);
+
+  // small moves (ramp, titration) pass straight through
+  transConfigure(300, 400, TRANS_COSINE);
+  transReset(8.0f);
+  CHECK(transUpdate(8.1f) == 8.1f);
+  CHECK(!transActive());
+
+  // a new step mid‑transition starts from where the trajectory is, no jump
+  transReset(6.0f);
+  shimMicros = 50000000u;
+  transUpdate(12.0f);
+  shimMicros += 150000;
+  const float mid = transUpdate(12.0f);
+  const float back = transUpdate(6.0f);
+  CHECK_RANGE(mid, 8.5, 9.5);
+  CHECK(fabsf(back - mid) < 0.01f);
+  CHECK(transActive());
+
+  return checkDone("transition");
+}
@@ -0,0 +1,118 @@
+// test_trigger.cpp – trigger/cycle timing and false triggers through the √ΔP flow law
+#include "check.h"
+#include "synth.h"
+#include "trigger.h"
+
+constexpr float K_SQRT = 30.0f;   // flowcal.h nominal, L/min per √hPa
+
+// Breaths with an end‑expiratory pause: inspiration a half sine of
+// peak_Lpm over ti_s, active expiration over te_s, then flow sits at zero
+// for pause_s, where the √ΔP law turns sensor noise into flow noise.
+struct PausedBreath {
+  float ti_s = 1.6f, te_s = 1.6f, pause_s = 0.8f, peak_Lpm = 30.0f;
+  float period_s() const { return ti_s + te_s + pause_s; }
+  float flow(double t) const {
+    const double tau = fmod(t, (double)period_s());
+    if (tau < ti_s) return peak_Lpm * (float)sin(M_PI * tau / ti_s);
+    if (tau < ti_s + te_s) return -peak_Lpm * (float)sin(M_PI * (tau - ti_s) / te_s);
+    return 0.0f;
+  }
+};
+
+struct Result {
+  int    breaths, triggers, missed, spurious;
+  double latAvg_ms, latMax_ms;     // true onset → trigger decision
+  double cycleErr_ms;              // |cycle − the 25 %‑of‑peak point|, worst
+  uint32_t falseCounted;           // TrigStats, < TRIG_FALSE_VT_ML inspired
+};
+
+// The firmware chain on each sample: ΔP = (Q / k)² with its sign, plus
+// sensor noise; Q = k·sgn√ΔP; the 2‑tap smoothing of breath.cpp; trigger.
+static Result run(const TrigConfig& cfg, float noise_hPa, double seconds = 240.0) {
+  PausedBreath b;
+  Noise noise;
+  trigConfigure(cfg);
+  trigReset();
+  trigStatsReset();
+  const uint32_t t0 = trigGetStats().triggers, f0 = trigGetStats().falseTriggers;
+
+  Result r{};
+  const double dt = 1.0 / SYNTH_FS_HZ, T = b.period_s();
+  const double cycleAt = b.ti_s * (1.0 - asin(cfg.cyclePct * 0.01) / M_PI);
+  float qf = 0.0f;
+  bool wasInsp = false, hit = false;
+  int lastBreath = -1;
+  double latSum = 0.0;
+  for (double t = 0.0; t < seconds; t += dt) {
+    const int k = (int)(t / T);
+    const double tau = t - k * T;
+    if (k != lastBreath) {           // breath 0 is the warm‑up: refractory from reset, no noise estimate
+      if (lastBreath >= 1 && !hit) r.missed++;
+      lastBreath = k;
+      hit = false;
+      if (k >= 1) r.breaths++;
+    }
+    const float q = b.flow(t);
+    const float dp = copysignf(q * q / (K_SQRT * K_SQRT), q) + noise(noise_hPa);
+    const float meas = K_SQRT * (dp >= 0.0f ? sqrtf(dp) : -sqrtf(-dp));
+    qf += 0.5f * (meas - qf);
+    shimMicros = 1000000u + (uint32_t)(t * 1e6);
+    trigSample(qf, (float)dt, shimMicros);
+
+    const bool insp = trigInspiring();
+    if (insp && !wasInsp && k >= 1) {
+      if (tau < 0.3 && !hit) {           // the breath's own trigger
+        hit = true;
+        latSum += tau * 1000.0;
+        r.latMax_ms = fmax(r.latMax_ms, tau * 1000.0);
+      } else {
+        r.spurious++;
+      }
+    }
+    if (!insp && wasInsp && hit && tau < b.ti_s + 0.5)
+      r.cycleErr_ms = fmax(r.cycleErr_ms, fabs(tau - cycleAt) * 1000.0);
+    wasInsp = insp;
+  }
+  r.triggers = (int)(trigGetStats().triggers - t0);
+  r.falseCounted = trigGetStats().falseTriggers - f0;
+  r.latAvg_ms = r.breaths - r.missed > 0 ? latSum / (r.breaths - r.missed) : 0.0;
+  return r;
+}
+
+static void show(const char* name, float noise_hPa, const Result& r) {
+  printf("  %-10s noise %.3f hPa: %d breaths, %d missed, %d spurious (%u < %.0f mL), "
+         "latency %.0f avg %.0f max ms, cycle ±%.0f ms\n",
+         name, noise_hPa, r.breaths, r.missed, r.spurious, r.falseCounted, TRIG_FALSE_VT_ML, r.latAvg_ms,
+         r.latMax_ms, r.cycleErr_ms);
+}
+
+int main() {
+  TrigConfig def;
+  TrigConfig flowOnly;
+  flowOnly.slope_Lps = 0.0f;
+
+  // ΔP noise: none; a pair of LPS22 at their low‑noise setting (~0.5 Pa);
+  // twice and four times that (mask bumps, blower ripple)
+  const float levels[] = { 0.0f, 0.005f, 0.01f, 0.02f };
+  const int maxSpurious[] = { 0, 0, 4, 6 };
+  const int maxMissed[]   = { 0, 0, 3, 3 };
+  for (uint8_t i = 0; i < 4; ++i) {
+    const float n = levels[i];
+    const Result f = run(flowOnly, n);
+    const Result s = run(def, n);
+    show("flow only", n, f);
+    show("flow+slope", n, s);
+    for (const Result* r : { &f, &s }) {
+      CHECK(r->spurious <= maxSpurious[i]);
+      CHECK(r->missed <= maxMissed[i]);
+      CHECK(r->latMax_ms <= 200.0);
+      CHECK(r->cycleErr_ms <= 60.0);
+    }
+    if (n == 0.0f) {
+      CHECK(s.latAvg_ms < f.latAvg_ms - 15.0);   // the slope path earns its keep on a clean signal
+      CHECK(f.latMax_ms <= 100.0);
+      CHECK(f.cycleErr_ms <= 30.0);
+    }
+  }
+  return checkDone("trigger");
+}
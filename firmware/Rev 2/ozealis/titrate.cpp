@@ -0,0 +1,84 @@
+// titrate.cpp – implementation
+#include "titrate.h"
+#include "breath.h"  // breathSeq(), breathGet()
+#include "apnea.h"   // apneaSeq(), apneaGet()
+
+static float    pressure = 4.0f;
+static uint8_t  flBits = 0, snoreBits = 0;  // last TITR_WINDOW breaths, newest in bit 0
+static uint8_t  nBreaths = 0;
+static uint32_t seenBreath = 0, seenEvent = 0;
+static uint32_t lastUpMs = 0, lastTriggerMs = 0, lastDownMs = 0;
+static uint8_t  pending = 0;   // triggers waiting for the gap to pass
+static uint8_t  lastReason = 0;
+
+static inline uint8_t popcount(uint8_t v) {
+  uint8_t c = 0;
+  for (; v; v &= v - 1) c++;
+  return c;
+}
+
+// ------------------------------------------------
+void titrReset(float start_cm) {
+  pressure = start_cm;
+  flBits = snoreBits = 0;
+  nBreaths = 0;
+  seenBreath = breathSeq();
+  seenEvent = apneaSeq();
+  lastUpMs = lastDownMs = 0;
+  lastTriggerMs = millis();
+  pending = 0;
+  lastReason = 0;
+}
+
+float titrUpdate(float pMin, float pMax) {
+  const uint32_t now = millis();
+  constexpr uint8_t mask = (1u << TITR_WINDOW) - 1;
+
+  // breath votes
+  BreathRecord r;
+  const uint32_t bSeq = breathSeq();
+  if (bSeq - seenBreath > BREATH_RING) seenBreath = bSeq - BREATH_RING;
+  for (; seenBreath < bSeq; ++seenBreath) {
+    if (!breathGet(seenBreath, r)) continue;
+    flBits    = ((flBits << 1) | (r.flowLimited ? 1 : 0)) & mask;
+    snoreBits = ((snoreBits << 1) | (r.flutter || r.snore ? 1 : 0)) & mask;
+    if (nBreaths < TITR_WINDOW) nBreaths++;
+  }
+  if (nBreaths >= TITR_WINDOW) {
+    if (popcount(flBits) >= TITR_FL_COUNT)    pending |= TITR_FL;
+    if (popcount(snoreBits) >= TITR_FL_COUNT) pending |= TITR_SNORE;
+  }
+
+  // scored events
+  ApneaEvent e;
+  const uint32_t eSeq = apneaSeq();
+  if (seenEvent > eSeq) seenEvent = 0;  // new session
+  for (; seenEvent < eSeq; ++seenEvent) {
+    if (!apneaGet(seenEvent, e)) continue;
+    if (e.airway == AIRWAY_OPEN) continue;  // central: more EPAP won't open an open airway
+    pending |= e.type == EVT_APNEA ? TITR_APNEA : TITR_HYPO;
+  }
+
+  if (pending) {
+    lastTriggerMs = now;
+    if (!lastUpMs || now - lastUpMs >= TITR_MIN_GAP_MS) {
+      pressure += (pending & TITR_APNEA) ? TITR_STEP_LARGE : TITR_STEP_SMALL;
+      lastReason = pending;
+      pending = 0;
+      lastUpMs = now;
+      // the breaths that voted for this step don't vote again
+      flBits = snoreBits = 0;
+      nBreaths = 0;
+    }
+  } else if (now - lastTriggerMs >= TITR_CLEAN_MS && now - lastDownMs >= TITR_CLEAN_MS) {
+    pressure -= TITR_STEP_SMALL;
+    lastReason = TITR_DOWN;
+    lastDownMs = now;
+  }
+
+  pressure = constrain(pressure, pMin, pMax);
+  return pressure;
+}
+
+float titrPressure_cm() { return pressure; }
+uint8_t titrLastReason() { return lastReason; }
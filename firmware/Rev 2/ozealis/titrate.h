@@ -0,0 +1,37 @@
+// titrate.h – auto‑titrating CPAP: EPAP from flow limitation, events, snore
+#ifndef TITRATE_H
+#define TITRATE_H
+
+#include <Arduino.h>
+
+/*  Evaluated per completed breath / event, never per sample:
+      flow limitation  ≥ TITR_FL_COUNT of the last TITR_WINDOW breaths → +TITR_STEP_SMALL
+      snore‑like       same vote on flutter or pressure vibration     → +TITR_STEP_SMALL
+      hypopnea                                                        → +TITR_STEP_SMALL
+      apnea, obstructive or unclassified                              → +TITR_STEP_LARGE
+    Central apneas (open airway, apnea.h) never raise the pressure.
+    Increases are spaced by TITR_MIN_GAP_MS. After TITR_CLEAN_MS with no
+    trigger the pressure steps back down by TITR_STEP_SMALL, toward pMin.  */
+
+constexpr uint8_t  TITR_WINDOW      = 5;
+constexpr uint8_t  TITR_FL_COUNT    = 3;
+constexpr float    TITR_STEP_SMALL  = 0.5f;     // cmH₂O
+constexpr float    TITR_STEP_LARGE  = 1.0f;
+constexpr uint32_t TITR_MIN_GAP_MS  = 20000;
+constexpr uint32_t TITR_CLEAN_MS    = 600000;   // 10 min
+
+// reasons for the last step, bitmask
+enum : uint8_t {
+  TITR_FL    = 0x01,
+  TITR_SNORE = 0x02,
+  TITR_HYPO  = 0x04,
+  TITR_APNEA = 0x08,
+  TITR_DOWN  = 0x80
+};
+
+void  titrReset(float start_cm);
+float titrUpdate(float pMin, float pMax);   // every papLoop in CPAP, returns EPAP
+float titrPressure_cm();
+uint8_t titrLastReason();
+
+#endif  // TITRATE_H
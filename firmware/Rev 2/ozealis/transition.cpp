@@ -0,0 +1,80 @@
+// transition.cpp – implementation
+#include "transition.h"
+#include <freertos/FreeRTOS.h>
+#include <math.h>
+
+// unit curve y(0)=0 → y(1)=1. Settings arrive from the BLE task: the new
+// table is built aside and copied in under the lock, the control tick
+// holds the same lock for its two points, so neither sees half a table
+struct TransTables {
+  float    y[TRANS_POINTS];
+  uint16_t rise_ms, fall_ms;
+};
+static TransTables table{};
+static portMUX_TYPE transMux = portMUX_INITIALIZER_UNLOCKED;
+
+static float    from = 0.0f, to = 0.0f, out = 0.0f;
+static uint32_t startMs = 0;
+static bool     active = false;
+static bool     rising = true;
+
+static void fill(float* t, TransShape shape) {  // rise and fall share it, mirrored by from/to
+  for (uint8_t i = 0; i < TRANS_POINTS; ++i) {
+    const float x = (float)i / (TRANS_POINTS - 1);
+    switch (shape) {
+      case TRANS_COSINE: t[i] = 0.5f * (1.0f - cosf(PI * x)); break;
+      case TRANS_EXP:    t[i] = (1.0f - expf(-5.0f * x)) / (1.0f - expf(-5.0f)); break;
+      default:           t[i] = x; break;
+    }
+  }
+}
+
+// ------------------------------------------------
+void transConfigure(uint16_t rise_ms, uint16_t fall_ms, TransShape shape) {
+  TransTables t;
+  fill(t.y, shape);
+  t.rise_ms = min(rise_ms, TRANS_MAX_MS);
+  t.fall_ms = min(fall_ms, TRANS_MAX_MS);
+  portENTER_CRITICAL(&transMux);
+  table = t;
+  portEXIT_CRITICAL(&transMux);
+}
+
+void transReset(float cm) {
+  from = to = out = cm;
+  active = false;
+}
+
+float transUpdate(float target) {
+  const uint32_t now = millis();
+  if (fabsf(target - to) >= TRANS_STEP_CM) {
+    // new step: start from wherever the current trajectory is
+    from = out;
+    to = target;
+    rising = to > from;
+    startMs = now;
+    active = true;
+  } else if (!active) {
+    to = out = target;   // small continuous moves pass straight through
+    return out;
+  }
+
+  const uint32_t el = now - startMs;
+  portENTER_CRITICAL(&transMux);
+  const uint16_t dur = rising ? table.rise_ms : table.fall_ms;
+  const bool done = dur == 0 || el >= dur;
+  const float pos = done ? 0.0f : (float)el * (TRANS_POINTS - 1) / dur;
+  const uint8_t i = (uint8_t)pos;
+  const float y0 = table.y[i], y1 = table.y[i + 1];
+  portEXIT_CRITICAL(&transMux);
+
+  if (done) {
+    out = to;
+    active = false;
+    return out;
+  }
+  out = from + (to - from) * (y0 + (pos - i) * (y1 - y0));
+  return out;
+}
+
+bool transActive() { return active; }
@@ -0,0 +1,27 @@
+// transition.h – shaped set‑point transitions (EPR, IPAP/EPAP)
+#ifndef TRANSITION_H
+#define TRANSITION_H
+
+#include <Arduino.h>
+
+/*  A step in the discrete target (phase switch, EPR) is replaced by a
+    trajectory from the value in force to the new target over the rise or
+    fall time. The unit curves are tabulated once per configuration, so a
+    tick is one lookup + lerp. Small moves (ramp, titration) pass through. */
+
+constexpr uint8_t  TRANS_POINTS    = 33;      // 32 segments
+constexpr float    TRANS_STEP_CM   = 0.2f;    // smaller target changes are not shaped
+constexpr uint16_t TRANS_MAX_MS    = 2000;
+
+enum TransShape : uint8_t {
+  TRANS_COSINE = 0,   // raised cosine, zero slope at both ends
+  TRANS_EXP,          // exponential, fast start, 5 τ to the target
+  TRANS_LINEAR
+};
+
+void  transConfigure(uint16_t rise_ms, uint16_t fall_ms, TransShape shape);  // rebuilds tables
+void  transReset(float cm);             // jump, no shaping (blower start, open loop)
+float transUpdate(float target_cm);     // each control tick, returns the shaped set‑point
+bool  transActive();
+
+#endif  // TRANSITION_H
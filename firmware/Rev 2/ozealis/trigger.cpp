@@ -0,0 +1,117 @@
+// trigger.cpp – implementation
+#include "trigger.h"
+
+// double buffered, settings arrive from the BLE task
+static TrigConfig cfgs[2];
+static volatile uint8_t live = 0;
+
+static bool     insp = false;
+static bool     havePrev = false;
+static float    prev = 0.0f, slope = 0.0f;
+static float    noiseVar = 0.0f;   // sample‑to‑sample flow variance in expiration, (L/min)²
+static float    peak = 0.0f, vol_mL = 0.0f;
+static uint8_t  confirm = 0;
+static uint32_t zcUs = 0;          // last upward zero crossing, sample clock
+static uint32_t edgeUs = 0;        // last trigger / cycle
+static uint32_t onsetUs = 0;       // of the breath being triggered
+static bool     cmdPending = false;
+static TrigStats stats{};
+
+// onset → command of the last few breaths, for trigLatencyFor()
+struct LatEntry {
+  uint32_t onset_us;
+  uint16_t lat_ms;
+};
+static LatEntry lat[4];
+static uint8_t  latHead = 0;
+
+static void cycle(uint32_t t) {
+  insp = false;
+  edgeUs = t;
+  cmdPending = false;
+  confirm = 0;
+  if (vol_mL < TRIG_FALSE_VT_ML) stats.falseTriggers++;
+}
+
+// ------------------------------------------------
+void trigConfigure(const TrigConfig& c) {
+  cfgs[live ^ 1] = c;
+  live ^= 1;
+}
+
+void trigReset() {
+  insp = havePrev = cmdPending = false;
+  slope = peak = vol_mL = noiseVar = 0.0f;
+  confirm = 0;
+  zcUs = edgeUs = 0;
+}
+
+void trigSample(float resp, float dt, uint32_t t) {
+  const TrigConfig& c = cfgs[live];
+  if (!havePrev) {
+    prev = resp;
+    havePrev = true;
+    edgeUs = t;
+    return;
+  }
+  const float d = resp - prev;
+  slope += min(1.0f, dt / TRIG_SLOPE_TAU_S) * (d / dt - slope);
+  if (!insp) noiseVar += min(1.0f, dt / TRIG_NOISE_TAU_S) * (d * d - noiseVar);
+  if (prev <= 0.0f && resp > 0.0f) zcUs = t;
+  prev = resp;
+
+  const uint32_t inPhase_ms = (t - edgeUs) / 1000;
+  if (!insp) {
+    const float noiseFloor = TRIG_NOISE_K * sqrtf(noiseVar);
+    const bool hit = resp > max(c.flow_Lpm, noiseFloor) ||
+                     (c.slope_Lps > 0.0f && resp > noiseFloor && slope > c.slope_Lps);
+    confirm = hit ? confirm + 1 : 0;
+    if (confirm >= TRIG_CONFIRM && inPhase_ms >= c.teMin_ms) {
+      insp = true;
+      edgeUs = t;
+      onsetUs = zcUs && t - zcUs < 1000000UL ? zcUs : t;
+      cmdPending = true;
+      peak = resp;
+      vol_mL = 0.0f;
+      confirm = 0;
+      stats.triggers++;
+    }
+  } else {
+    peak = max(peak, resp);
+    if (resp > 0.0f) vol_mL += resp * dt * (1000.0f / 60.0f);
+    if (inPhase_ms >= c.tiMax_ms) {
+      stats.backupCycles++;
+      cycle(t);
+    } else if (inPhase_ms >= c.tiMin_ms && resp < peak * c.cyclePct * 0.01f) {
+      cycle(t);
+    }
+  }
+}
+
+bool trigInspiring() { return insp; }
+
+bool trigCommand() {
+  if (cmdPending) {
+    cmdPending = false;
+    const uint16_t l = (uint16_t)min<uint32_t>(0xFFFE, (micros() - onsetUs) / 1000);
+    lat[latHead] = { onsetUs, l };
+    latHead = (latHead + 1) % 4;
+    stats.lastLat_ms = l;
+    stats.maxLat_ms = max(stats.maxLat_ms, l);
+    stats.avgLat_ms = stats.avgLat_ms > 0.0f ? stats.avgLat_ms + 0.1f * (l - stats.avgLat_ms) : l;
+  }
+  return insp;
+}
+
+uint16_t trigLatencyFor(uint32_t inspOnset_us) {
+  // both onsets come from zero crossings of the same signal
+  for (const LatEntry& e : lat)
+    if (e.onset_us && (uint32_t)abs((int32_t)(e.onset_us - inspOnset_us)) < 300000UL) return e.lat_ms;
+  return 0xFFFF;
+}
+
+const TrigStats& trigGetStats() { return stats; }
+
+void trigStatsReset() {
+  stats.maxLat_ms = 0;
+}
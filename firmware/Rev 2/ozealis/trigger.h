@@ -0,0 +1,55 @@
+// trigger.h – BiPAP/ASV inspiratory trigger and expiratory cycle
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <Arduino.h>
+
+/*  Runs on every respiratory flow sample (breath.h, leak removed), so the
+    decision is made at the FIFO rate, not per control period.
+      trigger  flow > flow_Lpm, or flow > 0 rising faster than slope_Lps,
+               for TRIG_CONFIRM samples, once teMin_ms into expiration
+      cycle    flow < cyclePct of this breath's peak, once tiMin_ms into
+               inspiration; tiMax_ms cycles regardless (backup)
+    Latency is onset → command: from the zero crossing the trigger grew
+    out of to the control tick that first drives IPAP (trigCommand()).
+    A breath cycled with less than TRIG_FALSE_VT_ML inspired is counted
+    as a false trigger (noise, cardiac oscillation, mask bump).
+    Flow is k·√ΔP, so near zero a fraction of a Pa of sensor noise is
+    several L/min of flow noise with a steep slope. The sample‑to‑sample
+    spread of the flow is tracked in expiration and both paths need the
+    flow above TRIG_NOISE_K times it (test/test_trigger.cpp).             */
+
+constexpr uint8_t TRIG_CONFIRM     = 2;       // consecutive samples
+constexpr float   TRIG_SLOPE_TAU_S = 0.02f;   // slope low‑pass
+constexpr float   TRIG_FALSE_VT_ML = 50.0f;
+constexpr float   TRIG_NOISE_TAU_S = 1.0f;    // expiratory noise estimate
+constexpr float   TRIG_NOISE_K     = 3.0f;
+
+struct TrigConfig {
+  float    flow_Lpm  = 3.0f;    // trigger threshold
+  float    slope_Lps = 40.0f;   // L/min per second, 0 = off
+  uint8_t  cyclePct  = 25;      // % of peak inspiratory flow
+  uint16_t tiMin_ms  = 300;     // inspiratory refractory
+  uint16_t tiMax_ms  = 3000;    // backup cycle
+  uint16_t teMin_ms  = 400;     // expiratory refractory
+};
+
+struct TrigStats {
+  uint32_t triggers;
+  uint32_t backupCycles;      // tiMax reached
+  uint32_t falseTriggers;
+  uint16_t lastLat_ms;
+  uint16_t maxLat_ms;         // since trigStatsReset()
+  float    avgLat_ms;
+};
+
+void  trigConfigure(const TrigConfig& cfg);
+void  trigReset();                                  // waveform lost, back to expiration
+void  trigSample(float resp_Lpm, float dt_s, uint32_t t_us);
+bool  trigInspiring();
+bool  trigCommand();          // papLoop, BiPAP/ASV: phase to drive, closes the latency
+uint16_t trigLatencyFor(uint32_t inspOnset_us);     // per breath, 0xFFFF = not commanded
+const TrigStats& trigGetStats();
+void  trigStatsReset();
+
+#endif  // TRIGGER_H